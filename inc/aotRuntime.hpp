@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "emulator.hpp"
+#include "packedLanes.hpp"
+
+//What code generated by the translator sees of the emulator it runs in.
+//Each translated block is a function taking the runtime; it updates the registers directly and
+//goes through the runtime for memory and interrupts, so devices and interrupts behave as in the emulator.
+class AotRuntime{
+public:
+    using Block = void (*)(AotRuntime&);
+    using Dispatcher = Block (*)(uint32_t pc);
+
+    //Memory contents embedded in the generated program
+    struct Segment{
+        uint32_t address;
+        const uint8_t* bytes;
+        size_t size;
+    };
+    struct Image{
+        const Segment* segments;
+        size_t segmentCount;
+        //Page numbers (address >> PAGE_BITS) of the translated code
+        const uint32_t* codePages;
+        size_t codePageCount;
+        //Translated block starting at the address, or nullptr
+        Dispatcher dispatcher;
+    };
+
+    //main() of a translated program
+    static int run(int argc, char** argv, const Image& image);
+
+    explicit AotRuntime(Emulator& emulator);
+
+    //Registers of the emulated processor; gpr[16] takes the writes into r0
+    uint32_t* const gpr;
+    int* const csr;
+
+    uint32_t read(uint32_t address) const { return emulator.readWordMem(address); }
+    void write(uint32_t address, uint32_t value) { emulator.writeWordMem(address, value); }
+    void copy(uint32_t destination, uint32_t source, uint32_t length) { emulator.copyMemory(destination, source, length); }
+    void fill(uint32_t destination, uint32_t value, uint32_t length) { emulator.fillMemory(destination, static_cast<uint8_t>(value), length); }
+    void softwareInterrupt() { emulator.raiseInterrupt(Emulator::SOFTWARE_INTERRUPT); emulator.blockExit = true; }
+    void illegalInstruction() { emulator.illegalInstructionInterrupt(); }
+    void halt() { emulator.emulatorRunning = false; emulator.blockExit = true; }
+    //The block jumps to itself and changes nothing else: wait for an interrupt once it returns
+    void idle() { emulator.enterIdle(); }
+    void handlerInstalled() { emulator.csrWritten(Emulator::HANDLER); }
+    //Count instructions the block executed
+    void retire(uint32_t count) { emulator.instructionCount += count; }
+    //True if the block has to return to the emulator right away
+    bool exit() const { return emulator.blockExit; }
+
+private:
+    Emulator& emulator;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+//Runs many independent emulations (an executable with a terminal input script each) in one process,
+//on a work-stealing pool of threads, and reports their results together.
+class BatchRunner{
+public:
+    struct Job{
+        std::string image;
+        //Terminal input, empty for none
+        std::string input;
+        //Virtual time rate; 0 runs the timer on the host's clock (which takes a device thread)
+        uint64_t instructionsPerSecond;
+        //Budgets, 0 for no limit
+        uint64_t maxInstructions;
+        uint64_t timeout;
+    };
+    struct Result{
+        enum Status{
+            NOT_RUN,
+            HALTED,
+            FAILED,
+            OUT_OF_INSTRUCTIONS,
+            OUT_OF_TIME,
+            NOT_LOADED
+        };
+        Status status = NOT_RUN;
+        //Why the image couldn't be loaded or emulation failed
+        std::string error;
+        //Captured terminal output
+        std::string output;
+        //Final state, as the emulator prints it
+        std::string state;
+        uint64_t instructions = 0;
+        double seconds = 0;
+    };
+
+    //Options a manifest line doesn't set
+    explicit BatchRunner(const Job& defaults) : defaults(defaults) {}
+    //Read the jobs of a manifest; see printUsage() for its format
+    void readManifest(const std::string& filename);
+    //Run all jobs on the given number of threads
+    void run(unsigned threads);
+    //Print the result of every job in manifest order, then a summary
+    void printResults(std::ostream& out) const;
+    //True if every job halted
+    bool allHalted() const;
+
+private:
+    Job defaults;
+    std::vector<Job> jobs;
+    std::vector<Result> results;
+    double wallSeconds = 0;
+    unsigned threadCount = 0;
+
+    void runJob(const Job& job, Result& result);
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <memory>
+#include "pagedMemory.hpp"
+
+//Per-page cache of decoded instructions, keyed by the (4-byte aligned) address they were fetched from.
+//Pages are indexed through a two-level table, the same way PagedMemory indexes its pages.
+//Entry has to provide a uint32_t 'generation' field; an entry is valid only while its generation
+//matches the generation of its page, so invalidating a page is a single increment.
+//Caches of cores running on different threads can share their generations (see share()).
+template<typename Entry>
+class DecodeCache{
+public:
+    static constexpr uint32_t SLOTS = PagedMemory::PAGE_SIZE / 4;
+
+    //Valid entry for the address, or nullptr if the address has not been decoded since the last invalidation
+    Entry* lookup(uint32_t address){
+        CachedPage* page = findPage(address);
+        if(!page) return nullptr;
+        Entry& entry = page->slots[(address & PagedMemory::PAGE_MASK) >> 2];
+        return entry.generation == __atomic_load_n(page->generation, __ATOMIC_ACQUIRE) ? &entry : nullptr;
+    }
+
+    //Slot for the address (the page is allocated if needed), and the generation to validate() it with once
+    //it is filled in; taken before, so a write into the page while the entry is filled in leaves it invalid
+    Entry& slot(uint32_t address, uint32_t& generation){
+        CachedPage* page = getPage(address);
+        generation = __atomic_load_n(page->generation, __ATOMIC_ACQUIRE);
+        return page->slots[(address & PagedMemory::PAGE_MASK) >> 2];
+    }
+    void validate(Entry& entry, uint32_t generation){
+        entry.generation = generation;
+    }
+
+    //Generation counter of the page holding the address (the page is allocated if needed).
+    //The counter stays at the same location until clear() or share() is called.
+    const uint32_t* generation(uint32_t address){
+        return getPage(address)->generation;
+    }
+
+    //Drop every decoded entry of the page holding the address; returns false if nothing was cached there
+    //(by any of the caches sharing their generations)
+    bool invalidate(uint32_t address){
+        if(sharedGenerations){
+            uint32_t* generation = &sharedGenerations[address >> PagedMemory::PAGE_BITS];
+            if(__atomic_load_n(generation, __ATOMIC_RELAXED) == 0) return false;
+            __atomic_fetch_add(generation, 1, __ATOMIC_RELEASE);
+            return true;
+        }
+        CachedPage* page = findPage(address);
+        if(!page) return false;
+        (*page->generation)++;
+        return true;
+    }
+
+    //Keep the generations of the pages in generations (one counter per page of the address space, all zero
+    //at first), shared with the caches of other cores that may run on other threads: a write through any of
+    //them then drops what all of them decoded from the page. Entries cached before are dropped, and counters
+    //handed out by generation() before move on for good.
+    void share(uint32_t* generations){
+        if(sharedGenerations == generations) return;
+        sharedGenerations = generations;
+        for(uint32_t i = 0; i < TABLE_SIZE; i++){
+            if(!directory[i]) continue;
+            for(uint32_t j = 0; j < TABLE_SIZE; j++){
+                CachedPage* page = (*directory[i])[j].get();
+                if(!page) continue;
+                page->ownGeneration++;
+                for(auto& entry: page->slots) entry.generation = 0;
+                attach(*page, (i << TABLE_BITS) | j);
+            }
+        }
+    }
+    //Drop everything
+    void clear(){
+        for(auto& table: directory) table.reset();
+    }
+
+private:
+    static constexpr uint32_t TABLE_BITS = 10;
+    static constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+    static constexpr uint32_t TABLE_MASK = TABLE_SIZE - 1;
+
+    struct CachedPage{
+        //Starts at 1 so that zero-initialized slots are never valid
+        uint32_t ownGeneration = 1;
+        //ownGeneration, or the page's counter in the shared generations
+        uint32_t* generation = &ownGeneration;
+        std::array<Entry, SLOTS> slots{};
+    };
+    using PageTable = std::array<std::unique_ptr<CachedPage>, TABLE_SIZE>;
+
+    std::array<std::unique_ptr<PageTable>, TABLE_SIZE> directory;
+    //Set by share(); a counter stays 0 until some cache holds the page, so writes elsewhere skip the increment
+    uint32_t* sharedGenerations = nullptr;
+
+    //Count the page's generation in its shared counter, marking the page as decoded from
+    void attach(CachedPage& page, uint32_t pageNumber){
+        page.generation = &sharedGenerations[pageNumber];
+        uint32_t unused = 0;
+        __atomic_compare_exchange_n(page.generation, &unused, 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    }
+
+    CachedPage* findPage(uint32_t address) const{
+        const PageTable* table = directory[address >> (PagedMemory::PAGE_BITS + TABLE_BITS)].get();
+        if(!table) return nullptr;
+        return (*table)[(address >> PagedMemory::PAGE_BITS) & TABLE_MASK].get();
+    }
+    CachedPage* getPage(uint32_t address){
+        auto& table = directory[address >> (PagedMemory::PAGE_BITS + TABLE_BITS)];
+        if(!table) table = std::make_unique<PageTable>();
+        auto& page = (*table)[(address >> PagedMemory::PAGE_BITS) & TABLE_MASK];
+        if(!page){
+            page = std::make_unique<CachedPage>();
+            if(sharedGenerations) attach(*page, address >> PagedMemory::PAGE_BITS);
+        }
+        return page.get();
+    }
+};
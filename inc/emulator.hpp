@@ -1,33 +1,164 @@
 #pragma once
 #include <string>
 #include <cstdint>
-#include <map>
 #include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <type_traits>
+#include <ostream>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include "pagedMemory.hpp"
+#include "decodeCache.hpp"
+#include "spscRing.hpp"
+#include "profiler.hpp"
+#include "symbolMap.hpp"
+#include "traceRing.hpp"
+class AotRuntime;
+class JitCompiler;
 class Emulator{
 public:
     Emulator();
+    ~Emulator();
     //Read the .hex file
     void readFile(const std::string& filename);
-    //Start emulation
-    void emulate();
+    //Copy a block of bytes into memory
+    void loadMemory(uint32_t address, const uint8_t* data, size_t length);
+    //Start emulation; returns true if the processor halted (or ran out of budget), false after a fatal error
+    bool emulate();
+    //Run hot code as translated blocks (default) or strictly one instruction at a time
+    void setBlockTranslation(bool enabled);
+    //Compile the hottest translated blocks into native code (default, on x86-64 hosts)
+    void setJit(bool enabled);
+    //Describe the native code compiled while running in /tmp/perf-<pid>.map, so that the host's perf can name it
+    void setPerfMap(bool enabled);
+    //Measure the timer's periods in retired instructions, at the given number of instructions per
+    //(virtual) second, instead of on the host's clock; 0 switches back to the host's clock
+    void setVirtualTime(uint64_t instructionsPerSecond);
+    //Run without the host's terminal: terminal input comes from inputFile ("-" for standard input,
+    //empty for none), read whole before emulation starts, and output goes to outputFile (empty for standard output)
+    void setHeadless(const std::string& inputFile, const std::string& outputFile);
+    //Send the terminal output of a headless run into out instead (after setHeadless)
+    void setHeadlessOutput(std::ostream& out);
+
+    //Emulate count cores sharing memory, each on its own host thread; with roundRobin they all run on the
+    //calling thread instead, in turns of quantum instructions, which makes runs repeatable
+    void setCores(unsigned count, bool roundRobin = false, uint64_t quantum = 10000);
+
+    //Make emulate() stop once the given number of instructions retired, or the given number of ms passed,
+    //counted from the start of emulate(); 0 for no limit (every core of the machine gets the whole budget)
+    void setBudget(uint64_t instructions, uint64_t milliseconds);
+    enum BudgetStop{
+        BUDGET_LEFT,
+        BUDGET_INSTRUCTIONS,
+        BUDGET_TIME
+    };
+    //Which budget the last emulate() stopped at, if any
+    BudgetStop budgetExhausted() const;
+    //Instructions retired so far (by core 0)
+    uint64_t retired() const;
+
+    //When to take the snapshot of a run
+    enum SnapshotTrigger{
+        //After the processor halts
+        SNAPSHOT_AT_HALT,
+        //After the program writes into the snapshot register
+        SNAPSHOT_ON_WRITE,
+        //Once the given number of instructions retired
+        SNAPSHOT_AT_INSTRUCTION
+    };
+    //Write the complete state of the emulated machine into the file once, at the trigger
+    void setSnapshot(const std::string& filename, SnapshotTrigger trigger, uint64_t instruction = 0);
+    //Start from the state saved in a snapshot file, in place of an executable (after setVirtualTime)
+    void restoreSnapshot(const std::string& filename);
+
+    //Make emulate() return at the trigger, so that the machine can be forked there
+    void setForkPoint(SnapshotTrigger trigger, uint64_t instruction = 0);
+    //New emulator in the same state, sharing memory pages copy-on-write; it doesn't inherit the terminal
+    //settings, snapshot or fork point. Only call it while emulate() isn't running. The two may then run on different threads.
+    //A machine whose cores ran on threads of their own can't be forked (std::logic_error), see PagedMemory::share().
+    std::unique_ptr<Emulator> fork() const;
+    //True if the last emulate() stopped at the fork point, false if the processor halted before reaching it
+    bool stoppedAtForkPoint() const { return forkPointReached; }
+    //Print the final state of the processor into out instead of standard output
+    void setStateOutput(std::ostream& out);
+
+    //Count retired instructions per address and interrupts per cause, and write a report into the file once emulation stops
+    void setProfile(const std::string& reportFile);
+    //Attribute retired instructions to call stacks (calls, returns and interrupt handlers), and write them
+    //into the file in the folded format of flame graph tools once emulation stops
+    void setCallGraph(const std::string& stacksFile);
+    //Name addresses in reports after the symbols in a map written by the linker
+    void setSymbolMap(const std::string& mapFile);
+    //Keep the last executed instructions (as many as entries) in memory and write them into the file once emulation stops or fails
+    void setTrace(const std::string& traceFile, size_t entries);
 private:
-    int gpr[16];
+    //State copied by fork()
+    Emulator(const Emulator& parent);
+
+    //Another core of the machine
+    Emulator(Emulator& machine, unsigned id);
+
+    //gpr[SINK] is not a real register: writes targeting r0 are redirected there, so r0 always reads as 0
+    int gpr[17];
     int csr[3];
-    std::map<uint32_t, uint8_t> memory;
+    //Shared by all cores of the machine
+    std::shared_ptr<PagedMemory> memory = std::make_shared<PagedMemory>();
     std::atomic<bool> emulatorRunning = false;
+    //Keeps the device thread going, for as long as any core may use the devices
+    std::atomic<bool> devicesRunning = false;
 
     /*--- Interrupt signals ---*/ 
     ///
-    bool softwareInterrupt = false;
-    bool illegalInstruction = false;
-    std::atomic<bool> terminalInterrupt = false;
-    std::atomic<bool> timerInterrupt = false;
+    //Bits of pendingInterrupts, in order of priority
+    static constexpr uint32_t ILLEGAL_INTERRUPT = 0x1;
+    static constexpr uint32_t SOFTWARE_INTERRUPT = 0x2;
+    static constexpr uint32_t TIMER_INTERRUPT = 0x4;
+    static constexpr uint32_t TERMINAL_INTERRUPT = 0x8;
+    static constexpr uint32_t IPI_INTERRUPT = 0x10;
+    static constexpr uint32_t DMA_INTERRUPT = 0x20;
+    //Interrupts raised and not taken yet; the CPU and device threads add to it with fetch_or
+    std::atomic<uint32_t> pendingInterrupts = 0;
 
-    /*--- Terminal's mapped registers (and a signaling line)---*/
+    /*--- Terminal's mapped register and queues ---*/
     ///
-    std::atomic<uint32_t> term_out;
-    std::atomic<bool> terminalSignal = false;
     std::atomic<uint32_t> term_in;
+    //Characters written to the terminal output register, printed by the device thread
+    SpscRing<uint8_t, 4096> terminalOutput;
+    //Characters typed, taken one per terminal interrupt
+    SpscRing<uint8_t, 4096> terminalInput;
+    //Terminal output DMA registers, a set for each core
+    uint32_t dmaAddress = 0;
+    uint32_t dmaLength = 0;
+    //Print the dmaLength bytes at dmaAddress at once, for a control register write
+    void terminalTransfer(uint32_t control);
+    //Set by the device thread when it stops reading input because terminalInput is full
+    std::atomic<bool> inputStalled = false;
+
+    /*--- Headless terminal, run by the CPU thread ---*/
+    ///
+    bool headless = false;
+    std::vector<uint8_t> headlessInput;
+    size_t headlessInputPosition = 0;
+    //Input is held back until the program installs its interrupt handler
+    bool headlessInputWaiting = false;
+    std::unique_ptr<std::ostream> outputFile;
+    std::ostream* headlessOutput = nullptr;
+    //Set by the first write into handler
+    bool handlerInstalled = false;
+    //Call after writing into a CSR
+    void csrWritten(uint8_t index){
+        if(index != HANDLER) return;
+        handlerInstalled = true;
+        if(headlessInputWaiting){
+            headlessInputWaiting = false;
+            raiseInterrupt(TERMINAL_INTERRUPT);
+        }
+    }
     
     /*--- Timer's mapped register (and a signaling line)---*/
     ///
@@ -41,6 +172,7 @@ private:
     ///
     static constexpr int PC = 15;
     static constexpr int SP = 14;
+    static constexpr int SINK = 16;
     static constexpr int STATUS = 0;
     static constexpr int HANDLER = 1;
     static constexpr int CAUSE = 2;
@@ -50,48 +182,426 @@ private:
     static constexpr uint32_t TERM_OUT_ADDR = 0xFFFFFF00;
     static constexpr uint32_t TERM_IN_ADDR = 0xFFFFFF04;
     static constexpr uint32_t TIM_CFG_ADDR = 0xFFFFFF10;
+    static constexpr uint32_t SNAPSHOT_ADDR = 0xFFFFFF20;
+    //Performance counters, read only; reading the low word of a 64-bit one latches its high word
+    static constexpr uint32_t PERF_INSTRET_ADDR = 0xFFFFFF30;
+    static constexpr uint32_t PERF_INSTRET_HI_ADDR = 0xFFFFFF34;
+    static constexpr uint32_t PERF_CLOCK_ADDR = 0xFFFFFF38;
+    static constexpr uint32_t PERF_CLOCK_HI_ADDR = 0xFFFFFF3C;
+    static constexpr uint32_t PERF_INTERRUPTS_ADDR = 0xFFFFFF40;
+    static constexpr uint32_t PERF_DECODES_ADDR = 0xFFFFFF44;
+    //Cores: ID of the reading core, number of cores, interrupts to the cores set in the mask written, hardware spinlock
+    static constexpr uint32_t CORE_ID_ADDR = 0xFFFFFF50;
+    static constexpr uint32_t CORE_COUNT_ADDR = 0xFFFFFF54;
+    static constexpr uint32_t IPI_ADDR = 0xFFFFFF58;
+    static constexpr uint32_t SPINLOCK_ADDR = 0xFFFFFF5C;
+    //Terminal output DMA: buffer address, length in bytes, and control, which reads 0 (no transfer outlasts
+    //the write that starts it); writing DMA_START prints the buffer, DMA_INTERRUPT_ON_DONE raises DMA_INTERRUPT after it
+    static constexpr uint32_t DMA_ADDRESS_ADDR = 0xFFFFFF60;
+    static constexpr uint32_t DMA_LENGTH_ADDR = 0xFFFFFF64;
+    static constexpr uint32_t DMA_CONTROL_ADDR = 0xFFFFFF68;
+    static constexpr uint32_t DMA_START = 0x1;
+    static constexpr uint32_t DMA_INTERRUPT_ON_DONE = 0x2;
 
     //Read a single byte
     uint8_t readByteMem(uint32_t address) const;
     //Read 4 bytes
     uint32_t readWordMem(uint32_t address) const;
+    //Read a mapped register; kept out of line, away from the common path of readWordMem
+    uint32_t readMappedWord(uint32_t address) const;
 
     //Write a single byte
     void writeWordMem(uint32_t address, uint32_t value);
     //Write 4 bytes
     void writeByteMem(uint32_t address, uint8_t byte);
+    //Copy or fill a block of bytes; the blocks must lie below the mapped address space
+    void copyMemory(uint32_t destination, uint32_t source, uint32_t length);
+    void fillMemory(uint32_t destination, uint8_t value, uint32_t length);
+    //Throw unless the block starting at the address lies below the mapped address space; access is "Read" or "Write"
+    static void checkBlockRange(uint32_t address, uint32_t length, const char* access);
+    //Drop the code decoded from a written block
+    void rangeWritten(uint32_t address, uint32_t length);
+    //Print a block of characters on the terminal (or into the headless output)
+    void writeTerminal(const uint8_t* data, size_t length);
+    //Print a character on the terminal (or into the headless output)
+    void writeTerminal(uint8_t ch);
+
+    /*--- Predecoded instructions ---*/
+    ///
+    struct DecodedInstruction;
+    using Handler = void (Emulator::*)(const DecodedInstruction&);
+    struct DecodedInstruction{
+        //Handler specialized for the instruction's opcode and modifier
+        Handler handler;
+        //Register fields, as read by the instruction
+        uint8_t a;
+        uint8_t b;
+        uint8_t c;
+        //Register fields, as written by the instruction (SINK in place of r0)
+        uint8_t ad;
+        uint8_t bd;
+        uint8_t cd;
+        //Displacement, already sign extended
+        int32_t disp;
+        //Bytes of code the instruction stands for: 4, or the length of a fused sequence
+        uint8_t length;
+        //Instructions it stands for: 1, or the ones of a fused sequence that always execute
+        uint8_t count;
+        //Inline literal of a fused sequence
+        uint32_t literal;
+        //Used by the decode cache to tell stale entries apart
+        uint32_t generation;
+        //Instruction as read from memory (the first word of a fused sequence), for the trace
+        uint32_t word;
+        //What the trace records, with the registers resolved when decoding:
+        //address gpr[traceFirst]+gpr[traceSecond] (r0 reads as 0), adjusted by traceFlags,
+        //value gpr[traceValue] (csr[traceValue] with TRACE_CSR)
+        uint8_t traceFirst;
+        uint8_t traceSecond;
+        uint8_t traceValue;
+        uint8_t traceFlags;
+    };
+    enum TraceFlags : uint8_t {
+        //Add the displacement to the address
+        TRACE_DISP = 0x1,
+        //The address is the one pushed onto the stack
+        TRACE_PUSH = 0x2,
+        //The address is read from memory at the address
+        TRACE_INDIRECT = 0x4,
+        //The value is a CSR
+        TRACE_CSR = 0x8
+    };
+    DecodeCache<DecodedInstruction> decodeCache;
+    //Holds the instruction when it can't be cached (PC not aligned or inside the mapped address space)
+    DecodedInstruction uncachedInstruction;
+
+    //Return the decoded instruction at the location of PC and increment PC by the instruction's length (always 4)
+    const DecodedInstruction& instructionFetch();
+    //Split the instruction word into its fields and pick its handler
+    void instructionDecode(uint32_t instruction, DecodedInstruction& decoded);
+    //Replace the decoded instruction with a single fused operation if it starts one of the
+    //sequences the assembler expands pseudo-instructions into (ld $imm, ld mem, call, jmp, beq/bne/bgt, st)
+    void fuseSequence(uint32_t address, uint32_t instruction, DecodedInstruction& decoded);
+
+    /*--- Handler table ---*/
+    ///
+    //Handler for the instruction byte (oc << 4 | mod); ILLEGAL_FIELDS selects the variant that
+    //also raises an illegal instruction interrupt because of operand fields the encoding doesn't allow
+    template<uint8_t OPCODE, bool ILLEGAL_FIELDS>
+    void execute(const DecodedInstruction& di);
+
+    template<size_t... OPCODES>
+    static constexpr std::array<Handler, 256> makeHandlerTable(std::index_sequence<OPCODES...>, std::false_type);
+    template<size_t... OPCODES>
+    static constexpr std::array<Handler, 256> makeHandlerTable(std::index_sequence<OPCODES...>, std::true_type);
+
+    /*--- Handlers for various instructions, specialized by modifier ---*/
+    ///
+    void executeHalt(const DecodedInstruction& di);
+    void executeWait(const DecodedInstruction& di);
+    void executeInt(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeCall(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeJump(const DecodedInstruction& di);
+    void executeXchg(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeArithmetic(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeLogic(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeShift(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeStore(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeLoad(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeMemoryBlock(const DecodedInstruction& di);
+    template<uint8_t MOD> void executePacked(const DecodedInstruction& di);
+    void executeIllegal(const DecodedInstruction& di);
+
+    /*--- Handlers for fused sequences, PC is the address of the sequence's first word + 4 ---*/
+    ///
+    void executeLoadLiteral(const DecodedInstruction& di);
+    void executeLoadMemoryLiteral(const DecodedInstruction& di);
+    void executeCallLiteral(const DecodedInstruction& di);
+    void executeJumpLiteral(const DecodedInstruction& di);
+    template<uint8_t MOD> void executeBranchLiteral(const DecodedInstruction& di);
+    void executeStoreLiteral(const DecodedInstruction& di);
+    //jmp or an always taken branch to itself: nothing changes until an interrupt comes
+    void executeIdleLoop(const DecodedInstruction& di);
+
+    //True if the operand fields are not allowed by the instruction's encoding
+    static bool hasIllegalFields(uint8_t oc, uint8_t mod, const DecodedInstruction& di);
+
+    /*--- Block translation ---*/
+    ///
+    struct BlockInstruction{
+        DecodedInstruction decoded;
+        //Value of PC while the instruction executes (its address + 4)
+        uint32_t nextPc;
+    };
+    //Straight-line run of instructions inside one page, ending at the first instruction that may change PC
+    //in a way that isn't known while translating (jumps, calls, int, halt, writes into PC)
+    struct TranslatedBlock{
+        uint32_t start;
+        std::vector<BlockInstruction> instructions;
+        //Instructions retired by running the whole block
+        uint32_t count;
+        //The block is stale once the decode cache generation of its page moves on
+        const uint32_t* pageGeneration;
+        uint32_t generation;
+        //Blocks that execution continued to after this one, entered without a lookup
+        struct Exit{
+            uint32_t pc;
+            TranslatedBlock* block;
+        };
+        Exit exits[2] = {};
+        uint8_t nextExit = 0;
+        //Native code compiled from the block once it ran JIT_THRESHOLD times, nullptr until then
+        void (*native)(Emulator*) = nullptr;
+        uint32_t executions = 0;
+
+        bool valid() const { return __atomic_load_n(pageGeneration, __ATOMIC_ACQUIRE) == generation; }
+        TranslatedBlock* chained(uint32_t pc) const;
+        void chain(uint32_t pc, TranslatedBlock* block);
+    };
+    //Blocks by start address; blocks are never freed, stale ones are translated again in place
+    std::unordered_map<uint32_t, std::unique_ptr<TranslatedBlock>> blocks;
+    bool blockTranslation = true;
+    //Set when the running block has to stop early (interrupt raised, halt, code in a cached page overwritten)
+    bool blockExit = false;
+
+    //Main loop variants; PROFILE counts every retired instruction in the profiler, TRACE records it in the trace
+    template<bool PROFILE, bool TRACE> void run();
+    template<bool PROFILE, bool TRACE> void runInterpreter();
+    template<bool PROFILE, bool TRACE> void runBlocks();
+    //Execute a single instruction fetched from pc, for the profiler and the trace
+    template<bool PROFILE, bool TRACE> void executeInstruction(uint32_t pc, const DecodedInstruction& di);
+    //Valid block starting at PC (translated if needed), or nullptr if PC can't start a block
+    TranslatedBlock* findBlock(uint32_t pc);
+    void translateBlock(TranslatedBlock& block);
+    //True if the block goes on after the instruction at the address; nextAddress is where
+    static bool continuesBlock(uint32_t instruction, const DecodedInstruction& di, uint32_t address, uint32_t& nextAddress);
+    template<bool PROFILE, bool TRACE> void executeBlock(const TranslatedBlock& block);
 
-    //Read instruction from the location of PC and increment PC by the instruction's length (always 4)
-    uint32_t instructionFetch();
-    //Decode and execute instruction
-    void instructionDecodeAndExecute(uint32_t instruction);
-
-    /*--- Handlers for various instructions---*/
-    ///
-    void executeHalt(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeInt(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeCall(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeJump(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeXchg(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeArithmetic(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeLogic(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeShift(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeStore(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
-    void executeLoad(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp);
+    /*--- Native code compiled while running ---*/
+    ///
+    friend class JitCompiler;
+    std::unique_ptr<JitCompiler> jit;
+    bool jitEnabled = true;
+    bool perfMap = false;
+    //Executions after which a block gets compiled
+    static constexpr uint32_t JIT_THRESHOLD = 16;
+    void compileBlock(TranslatedBlock& block);
+    void executeCompiled(const TranslatedBlock& block);
+
+    /*--- Native code from the ahead-of-time translator ---*/
+    ///
+    friend class AotRuntime;
+    using NativeBlock = void (*)(AotRuntime&);
+    using NativeDispatcher = NativeBlock (*)(uint32_t pc);
+    NativeDispatcher nativeDispatcher = nullptr;
+    AotRuntime* nativeRuntime = nullptr;
+    //Decode cache generations of the pages the native code was translated from
+    std::vector<std::pair<const uint32_t*, uint32_t>> nativePages;
+    //Cleared for good once any of those pages is written to
+    bool nativeCodeValid = false;
+
+    //Run native blocks where the dispatcher has one; pages holds the page numbers (address >> PAGE_BITS) they came from
+    void setNativeCode(AotRuntime* runtime, NativeDispatcher dispatcher, const uint32_t* pages, size_t pageCount);
+    void checkNativeCode();
     
     //Call if the instruction has inappropriate modifier or operands
     void illegalInstructionInterrupt();
 
+    /*--- Virtual time ---*/
+    ///
+    //Instructions retired so far
+    uint64_t instructionCount = 0;
+    //Virtual clock rate in instructions per second; 0 runs the timer on the host's clock
+    uint64_t virtualRate = 0;
+    //instructionCount at which the next virtual timer interrupt is due (never, while the timer isn't running in virtual time)
+    uint64_t timerDeadline = UINT64_MAX;
+    //Timer period for a tim_cfg setting, in instructions
+    uint64_t virtualTimerPeriod(uint32_t cfg) const;
+    void virtualTimerTick();
+
+    /*--- Performance counters ---*/
+    ///
+    //Interrupts taken so far
+    uint32_t interruptsTaken = 0;
+    //Instructions decoded so far: decode cache misses, and instructions translated into blocks
+    uint32_t instructionsDecoded = 0;
+    //Host's monotonic clock when emulation started, in ns
+    uint64_t clockStart = 0;
+    //High word latched by the last read of a 64-bit counter's low word
+    mutable uint32_t counterHigh = 0;
+    //Block being executed, so that counters read inside it count the instructions before the reading one
+    //(the block's are only counted once it is done)
+    const TranslatedBlock* runningBlock = nullptr;
+    //Instructions retired before the one executing
+    uint64_t retiredInstructions() const;
+    //ns since emulation started: emulated time in virtual time, the host's clock otherwise
+    uint64_t clockNanoseconds() const;
+    //Host's monotonic clock, in ns
+    static uint64_t monotonicNanoseconds();
+
+    /*--- Snapshots ---*/
+    ///
+    std::string snapshotFile;
+    SnapshotTrigger snapshotTrigger = SNAPSHOT_AT_HALT;
+    //instructionCount at which the snapshot is due (never, unless one was requested)
+    uint64_t snapshotDeadline = UINT64_MAX;
+    //Stop at the trigger instead of writing a snapshot file
+    bool forkPoint = false;
+    //Set once emulate() stopped at the fork point
+    bool forkPointReached = false;
+    //Set when the restored snapshot was taken after the processor halted; emulate() then runs nothing
+    bool restoredHalted = false;
+    //True if the trigger still has to be acted upon
+    bool snapshotArmed() const { return forkPoint || !snapshotFile.empty(); }
+    void snapshotReached(bool halted = false);
+    void writeSnapshot(bool halted);
+
+    /*--- Budget ---*/
+    ///
+    uint64_t budgetInstructions = 0;
+    uint64_t budgetMilliseconds = 0;
+    //instructionCount and host's clock at which emulate() stops
+    uint64_t budgetEnd = UINT64_MAX;
+    uint64_t budgetTimeEnd = UINT64_MAX;
+    //instructionCount at which the budget is checked next; the clock is looked at every BUDGET_CLOCK_INTERVAL instructions
+    uint64_t budgetDeadline = UINT64_MAX;
+    static constexpr uint64_t BUDGET_CLOCK_INTERVAL = 1 << 20;
+    BudgetStop budgetStop = BUDGET_LEFT;
+    void startBudget();
+    void budgetReached();
+
+    //The earliest of timerDeadline, snapshotDeadline, budgetDeadline and quantumDeadline
+    uint64_t nextDeadline = UINT64_MAX;
+    void updateDeadline(){ nextDeadline = std::min({timerDeadline, snapshotDeadline, budgetDeadline, quantumDeadline}); }
+    //Handle the deadlines instructionCount reached
+    void deadlineReached();
+
     //Call after executing an instruction
-    void handleInterrupts();
+    void handleInterrupts(){
+        if(instructionCount >= nextDeadline) deadlineReached();
+        //Nothing pending is the common case, and costs a single load and branch
+        if(pendingInterrupts.load(std::memory_order_relaxed) != 0) takeInterrupt();
+    }
+    //Enter the handler of the pending interrupt with the highest priority, unless all of them are masked
+    void takeInterrupt();
+    void raiseInterrupt(uint32_t interrupt){
+        //Release, so that whoever takes the interrupt sees what was queued before raising it;
+        //sequentially consistent with the look at parked, see sleep()
+        pendingInterrupts.fetch_or(interrupt, std::memory_order_seq_cst);
+        if(parked.load()) wake();
+    }
+    //True if a pending interrupt isn't masked
+    bool interruptTakeable() const;
+    //Move the next typed character into term_in; returns false if there is none
+    bool latchTerminalInput();
+
+    /*--- Idle loop ---*/
+    ///
+    //Set by an idle loop, until deadlineReached() waits for an interrupt
+    bool idle = false;
+    //Set on a core that ended its turn in an idle loop (running in turns, on the host's clock)
+    bool idleTurn = false;
+    //Set while the CPU thread sleeps in sleep()
+    std::atomic<bool> parked = false;
+    std::mutex idleLock;
+    std::condition_variable idleSignal;
+    //Make deadlineReached() wait for an interrupt right after the instruction
+    void enterIdle(){
+        idle = true;
+        nextDeadline = 0;
+    }
+    //Go on from an idle loop once an interrupt can be taken: skip to the next deadline in virtual time,
+    //sleep otherwise (or end the turn, running in turns)
+    void waitForInterrupt();
+    //Sleep until an interrupt can be taken (if interrupts is set), the core is stopped or the time budget
+    //runs out; returns false in the last case
+    bool sleep(bool interrupts);
+    //Wake the CPU thread up from sleep()
+    void wake();
+
+    /*--- Devices ---*/
+    ///
+    //eventfd the CPU writes to when the device thread has something to do (output, timer start, stop)
+    int doorbell = -1;
+    void ringDoorbell();
+
+    //Device thread's function: runs the timer and the terminal, sleeping in epoll until
+    //the timer expires, input arrives or the doorbell rings
+    void devices();
 
-    //Timer thread's function
-    void timer();
+    //Timer period for a tim_cfg setting, in milliseconds
+    static uint32_t timerPeriod(uint32_t cfg);
+
+    /*--- Profiling ---*/
+    ///
+    std::unique_ptr<Profiler> profiler;
+    std::string profileFile;
+    std::string callGraphFile;
+    std::unique_ptr<SymbolMap> symbolMap;
+    void writeProfile();
+
+    /*--- Execution trace ---*/
+    ///
+    std::unique_ptr<TraceRing> trace;
+    std::string traceFile;
+    //Memory address the instruction is about to read or write (PC already past it), 0 if none
+    uint32_t traceAddress(const DecodedInstruction& di) const{
+        uint32_t address = gpr[di.traceFirst] + gpr[di.traceSecond];
+        if(di.traceFlags & TRACE_DISP) address += di.disp;
+        if(di.traceFlags & TRACE_PUSH) address -= 4;
+        if(di.traceFlags & TRACE_INDIRECT) address = memory->readWord(address);
+        return address;
+    }
+    //Value of the register the instruction wrote, or the value it stored
+    uint32_t traceValue(const DecodedInstruction& di) const{
+        return (di.traceFlags & TRACE_CSR) ? csr[di.traceValue] : gpr[di.traceValue];
+    }
+    //Fill in the trace fields of a decoded instruction
+    static void traceDecode(uint8_t oc, uint8_t mod, DecodedInstruction& decoded);
+
+    /*--- Cores ---*/
+    ///
+    //Core 0 is the emulator the program is loaded into, it owns the devices and takes their interrupts.
+    //The other cores are created by emulate() and share its memory; machine points to core 0 (itself, for core 0)
+    Emulator* machine = this;
+    unsigned coreId = 0;
+    unsigned coreCount = 1;
+    std::vector<std::unique_ptr<Emulator>> otherCores;
+    bool roundRobin = false;
+    uint64_t roundRobinQuantum = 0;
+    //Set on core 0 while the cores run on threads of their own
+    bool parallelCores = false;
+    //Set on every core running in turns: a write has to drop the code the other cores decoded from it too
+    bool sharedCode = false;
+    //Decode cache generation of every page, shared by the cores' caches once they ran on threads of their own
+    std::unique_ptr<uint32_t[]> codeGenerations;
+    //instructionCount at which the core's turn ends
+    uint64_t quantumDeadline = UINT64_MAX;
+    bool quantumExpired = false;
+    //Message of the fatal error that stopped the core
+    std::string coreError;
+    //Held by parallel cores while they write into the terminal
+    std::mutex terminalLock;
+    //The spinlock register: 1 while some core holds it
+    std::atomic<uint32_t> spinlock = 0;
 
-    //Terminal thread's function
-    void terminal();
+    Emulator& core(unsigned id){ return id == 0 ? *this : *otherCores[id - 1]; }
+    //Create the other cores and get every one of them ready to run
+    void startCores();
+    //Run all cores until all of them halted or one of them failed or ran out of budget
+    void runCores();
+    void runParallel();
+    void runRoundRobin();
+    //Stop every core (after a fatal error or at a budget)
+    void stopCores();
+    //Raise the inter-processor interrupt on the cores set in the mask
+    void interruptCores(uint32_t mask);
+    //Drop code decoded from the written address by all cores but the writer
+    void invalidateCores(uint32_t address, const Emulator* writer);
 
-    //Print out the states of all GPRs
+    //Where the final state goes, standard output by default
+    std::ostream* stateOutput;
+    //Print out the states of all GPRs (of every core)
     void printRegisters();
 
 };
\ No newline at end of file
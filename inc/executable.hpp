@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+//Executable produced by the linker (hex mode):
+//the header, the segment table, then the contents of every segment, each starting at a page-aligned file offset
+struct ExecutableHeader {
+    uint8_t magic[8];
+    uint32_t segmentCount;
+    uint32_t segmentTableOffset;
+};
+
+//Bytes to load at address, taken from the file at offset
+struct ExecutableSegment {
+    uint32_t address;
+    uint32_t size;
+    uint32_t offset;
+};
+
+constexpr uint8_t EXECUTABLE_MAGIC[8] = {'S', 'H', 'E', 'X', 'E', 'C', 0, 1};
+constexpr uint32_t EXECUTABLE_ALIGNMENT = 4096;
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+//Reads an executable produced by the linker (hex mode) into contiguous segments of memory contents.
+//The segmented format is mapped into memory and its segments point straight into the mapping;
+//the old format (4B address, 1B value for every byte) is still accepted.
+class ImageReader {
+public:
+    //Read given file
+    explicit ImageReader(const std::string& filename);
+    ~ImageReader();
+    ImageReader(const ImageReader&) = delete;
+    ImageReader& operator=(const ImageReader&) = delete;
+
+    struct Segment{
+        uint32_t address;
+        //Valid as long as the reader exists
+        const uint8_t* bytes;
+        size_t size;
+    };
+    //Segments sorted by address, no two of them overlap
+    const std::vector<Segment>& getSegments() const;
+
+private:
+    std::vector<Segment> segments;
+
+    //Mapping of a file in the segmented format
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    //Contents of the segments of a file in the old format
+    std::vector<std::vector<uint8_t>> legacyContents;
+
+    void parseFile(const std::string& filename);
+    void parseSegments(const std::string& filename);
+    void parseLegacy(const std::string& filename);
+};
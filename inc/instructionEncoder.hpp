@@ -29,6 +29,7 @@ public:
     static std::vector<uint8_t> halt();
     static std::vector<uint8_t> intr();
     static std::vector<uint8_t> iret();
+    static std::vector<uint8_t> wait();
     static std::vector<uint8_t> call(int address);
     static std::vector<uint8_t> ret();
 
@@ -54,6 +55,13 @@ public:
     static std::vector<uint8_t> shl(int gprS, int gprD);
     static std::vector<uint8_t> shr(int gprS, int gprD);
 
+    //Block of gprN bytes: copied from [gprS] to [gprD], or filled with the low byte of gprS
+    static std::vector<uint8_t> copy(int gprS, int gprD, int gprN);
+    static std::vector<uint8_t> fill(int gprS, int gprD, int gprN);
+
+    //Packed arithmetic on the lanes of gprD and gprS; operation is one of PackedLanes::Operation
+    static std::vector<uint8_t> packed(uint8_t operation, int gprS, int gprD);
+
     static std::vector<uint8_t> ld_immediate(int gpr, int imm);
     static std::vector<uint8_t> ld_memory(int gpr, int address);
     static std::vector<uint8_t> ld_register(int gpr, int reg);
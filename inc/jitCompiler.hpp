@@ -0,0 +1,144 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <exception>
+#include "emulator.hpp"
+
+//Compiles hot translated blocks of an emulator into x86-64 machine code, in a buffer of its own.
+//Compiled code keeps the block's most used registers in host registers, does register arithmetic,
+//literal loads and branches inline, goes through the emulator for memory (and so for the mapped registers),
+//and calls the handlers for everything else. It jumps straight into the compiled code of the next block
+//while no deadline is due and no interrupt is pending, which is what the emulator would check between them.
+class JitCompiler{
+public:
+    using Code = void (*)(Emulator*);
+
+    explicit JitCompiler(Emulator& emulator);
+    ~JitCompiler();
+    JitCompiler(const JitCompiler&) = delete;
+    JitCompiler& operator=(const JitCompiler&) = delete;
+
+    //True if the host runs the code compiled (x86-64 Linux)
+    static bool supported();
+    //Compile the block, or return nullptr if it can't be; may drop every block compiled before to make room
+    Code compile(Emulator::TranslatedBlock& block);
+    //Describe the code compiled from now on in /tmp/perf-<pid>.map, for the host's perf
+    void setPerfMap(bool enabled) { perfMap = enabled; }
+    //Throw the error that stopped the code that just ran, if one did
+    void rethrow();
+
+private:
+    Emulator& emulator;
+
+    //Executable buffer, filled from the start and dropped whole once full
+    uint8_t* buffer = nullptr;
+    size_t used = 0;
+    static constexpr size_t BUFFER_SIZE = 16 << 20;
+
+    bool perfMap = false;
+    void describe(const uint8_t* code, size_t size, uint32_t start);
+
+    //Set (with the emulator's blockExit) when a call out of compiled code throws; the code then returns right away
+    bool failed = false;
+    std::exception_ptr error;
+    void fail();
+
+    //Block a jump to a PC known only while running (ret) went to last time, for each such jump
+    struct IndirectExit{
+        uint32_t pc = 0;
+        Emulator::TranslatedBlock* block = nullptr;
+    };
+    std::deque<IndirectExit> indirectExits;
+
+    /*--- Called by the compiled code ---*/
+    ///
+    static uint32_t readWord(Emulator* emulator, uint32_t address);
+    static void writeWord(Emulator* emulator, uint32_t address, uint32_t value);
+    static void execute(Emulator* emulator, const Emulator::DecodedInstruction* di);
+    //Remember the block at the PC (if there is one) for the jump
+    static void indirectMiss(Emulator* emulator, IndirectExit* exit, uint32_t pc);
+
+    /*--- Code generation ---*/
+    ///
+    //Host registers, numbered as in the encoding
+    enum Register : uint8_t{
+        RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+        R12 = 12, R13 = 13, R14 = 14, R15 = 15
+    };
+    //Condition codes of jcc
+    enum Condition : uint8_t{
+        ABOVE_OR_EQUAL = 0x3, EQUAL = 0x4, NOT_EQUAL = 0x5, GREATER = 0xF
+    };
+    //Callee saved host registers the block's registers are kept in, rbx holds the emulator
+    static constexpr Register CACHE_REGISTERS[] = {RBP, R12, R13, R14, R15};
+    //Bytes of the prologue that saves the host registers; a block jumping to another one enters past it
+    static constexpr size_t PROLOGUE_SIZE = 17;
+    //Offset of native in a TranslatedBlock
+    int32_t nativeOffset = 0;
+
+    std::vector<uint8_t> code;
+    //Positions of the rel32 fields of jumps to the epilogue
+    std::vector<size_t> leaveJumps;
+    //A jump out of the middle of the block, after a call out of it stopped the block
+    struct Stub{
+        size_t jump;
+        //PC after the instruction, unless the handler set it already; instructions retired up to it
+        bool setPc;
+        uint32_t pc;
+        uint32_t count;
+    };
+    std::vector<Stub> stubs;
+    //Host register (0 if none) each emulated register is kept in while the block runs, dirty ones differ from gpr[]
+    uint8_t cached[17];
+    uint32_t dirty;
+
+    //Byte offsets of the emulator's members from its address
+    int32_t gprOffset(uint8_t index) const;
+    int32_t memberOffset(const void* member) const;
+
+    void emit8(uint8_t byte) { code.push_back(byte); }
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+    void rex(bool wide, uint8_t reg, uint8_t rm);
+    //[rbx+disp32] operand
+    void memoryOperand(uint8_t reg, int32_t offset);
+
+    void movRegReg(Register destination, Register source);
+    void movRegImm(Register destination, uint32_t value);
+    void movRegImm64(Register destination, uint64_t value);
+    void movRegMem(Register destination, int32_t offset);
+    void movMemReg(int32_t offset, Register source);
+    void movMemImm(int32_t offset, uint32_t value);
+    //op dst, src for add, sub, and, or, xor (the opcode of the r/m32, r32 form)
+    void aluRegReg(uint8_t opcode, Register destination, Register source);
+    void addRegImm(Register destination, int32_t value);
+    //instructionCount += count
+    void addCount(uint32_t count);
+    void callAbsolute(uint64_t function);
+    size_t jump();
+    size_t jump(Condition condition);
+    void bind(size_t jump, size_t target);
+    void jumpLeave() { leaveJumps.push_back(jump()); }
+    void jumpLeave(Condition condition) { leaveJumps.push_back(jump(condition)); }
+
+    //Value of the emulated register as the instruction reads it (PC is the address after the instruction)
+    void loadRegister(Register destination, uint8_t index, uint32_t nextPc);
+    void storeRegister(uint8_t index, Register source);
+    //Write the dirty cached registers back into gpr[], or read all of them from there
+    void flushRegisters();
+    void reloadRegisters();
+    //Call out of the compiled code for the instruction; stop the block if it set blockExit, with PC at pcAfter if setPc is set
+    void callOut(uint64_t function, uint32_t nextPc, uint32_t count, bool setPc, uint32_t pcAfter = 0);
+    //Set PC, count the retired instructions and go on to the block at the PC (if chain is set) or return
+    void exitBlock(uint32_t pc, uint32_t count, bool chain);
+    //The same for the PC in ecx
+    void exitIndirect(uint32_t count);
+    //Return unless the emulator would go straight on to the next block (clobbers rax)
+    void checkContinue();
+
+    void selectCachedRegisters(const Emulator::TranslatedBlock& block);
+    //Emit native code for the instruction; returns false if it has to go through its handler instead
+    bool compileInstruction(const Emulator::BlockInstruction& instruction, uint32_t count, bool last);
+};
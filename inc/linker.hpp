@@ -18,6 +18,9 @@ public:
     //Generate the executable. (hex mode)
     void link(const std::string& outputFilename);
 
+    //Write the addresses of sections and symbols of the linked executable into a text file. (hex mode, after link)
+    void writeSymbolMap(const std::string& filename) const;
+
     //Generate the object file. (relocatable mode)
     void linkRelocatable(const std::string& outputFilename);
 
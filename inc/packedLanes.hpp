@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+
+//Packed arithmetic on the lanes of a 32-bit register: four bytes or two halfwords, all of them unsigned.
+//Every operation works on the whole word at once (SIMD within a register), masking off the top bit of
+//each lane so no carry or borrow crosses into the next one. Shared by the emulator and translated code.
+class PackedLanes{
+public:
+    //Modifiers of the packed opcode; the byte operations come first, then the same ones on halfwords
+    enum Operation : uint8_t{
+        ADD_BYTES, SUB_BYTES, EQUAL_BYTES, GREATER_BYTES, MIN_BYTES, MAX_BYTES,
+        ADD_HALVES, SUB_HALVES, EQUAL_HALVES, GREATER_HALVES, MIN_HALVES, MAX_HALVES,
+        SHUFFLE_BYTES,
+        OPERATIONS
+    };
+
+    //Result of the operation on the lanes of x and y (x - y, x > y and so on); comparisons set a lane to all ones if it holds
+    template<uint8_t MOD>
+    static uint32_t apply(uint32_t x, uint32_t y){
+        constexpr uint32_t high = MOD < ADD_HALVES ? 0x80808080u : 0x80008000u;
+        constexpr uint8_t operation = MOD < ADD_HALVES ? MOD : MOD - ADD_HALVES;
+        if constexpr (MOD == SHUFFLE_BYTES){
+            return shuffle(x, y);
+        }else if constexpr (operation == ADD_BYTES){
+            return ((x & ~high) + (y & ~high)) ^ ((x ^ y) & high);
+        }else if constexpr (operation == SUB_BYTES){
+            return ((x | high) - (y & ~high)) ^ ((x ^ ~y) & high);
+        }else if constexpr (operation == EQUAL_BYTES){
+            return mask<high>(equal<high>(x, y));
+        }else if constexpr (operation == GREATER_BYTES){
+            return mask<high>(greater<high>(x, y));
+        }else if constexpr (operation == MIN_BYTES){
+            uint32_t greaterLanes = mask<high>(greater<high>(x, y));
+            return (y & greaterLanes) | (x & ~greaterLanes);
+        }else{
+            uint32_t greaterLanes = mask<high>(greater<high>(x, y));
+            return (x & greaterLanes) | (y & ~greaterLanes);
+        }
+    }
+
+    //Byte i of the result is the byte of x that byte i of y selects (its low 2 bits), or 0 if bit 7 of the selector is set
+    static uint32_t shuffle(uint32_t x, uint32_t y){
+        uint32_t result = 0;
+        for(int lane = 0; lane < 4; lane++){
+            uint32_t selector = (y >> (8 * lane)) & 0xFF;
+            if(selector & 0x80) continue;
+            result |= ((x >> (8 * (selector & 0x3))) & 0xFF) << (8 * lane);
+        }
+        return result;
+    }
+
+private:
+    //Top bit of every lane where x and y are equal
+    template<uint32_t HIGH>
+    static uint32_t equal(uint32_t x, uint32_t y){
+        uint32_t difference = x ^ y;
+        //The top bit ends up set in every lane with any bit set
+        uint32_t different = (((difference & ~HIGH) + ~HIGH) | difference) & HIGH;
+        return different ^ HIGH;
+    }
+    //Top bit of every lane where x is greater than y
+    template<uint32_t HIGH>
+    static uint32_t greater(uint32_t x, uint32_t y){
+        //Lanes whose low bits in x exceed those in y: y - x borrows from the top bit
+        uint32_t lowGreater = ~((y | HIGH) - (x & ~HIGH)) & HIGH;
+        //The top bits decide unless they are the same
+        return ((x & ~y) | (~(x ^ y) & lowGreater)) & HIGH;
+    }
+    //Whole lanes out of their top bits
+    template<uint32_t HIGH>
+    static uint32_t mask(uint32_t topBits){
+        constexpr uint32_t ones = HIGH == 0x80808080u ? 0xFF : 0xFFFF;
+        constexpr unsigned shift = HIGH == 0x80808080u ? 7 : 15;
+        return (topBits >> shift) * ones;
+    }
+};
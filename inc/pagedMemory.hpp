@@ -0,0 +1,160 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <cstddef>
+#include <mutex>
+#include <atomic>
+
+//Sparse 32-bit address space made of 4 KiB pages, reached through a two-level page table.
+//Pages are allocated on the first write; reading an untouched location returns 0 without allocating.
+//A copy shares all pages with the original copy-on-write: whichever of them writes into a shared page first
+//gets a private copy of it, so copies can be used from different threads.
+//A single memory can also be used from several threads at once (see share()); aligned words are then
+//read and written whole, so no thread ever sees a word half written.
+class PagedMemory{
+public:
+    PagedMemory() = default;
+    //Shares all pages copy-on-write; throws std::logic_error if the memory was share()d
+    PagedMemory(const PagedMemory& other);
+    PagedMemory& operator=(const PagedMemory&) = delete;
+
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+    static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+
+    //Read a single byte
+    uint8_t readByte(uint32_t address) const{
+        const uint8_t* page = findPage(address);
+        return page ? page[address & PAGE_MASK] : 0;
+    }
+    //Read 4 bytes (little endian)
+    uint32_t readWord(uint32_t address) const{
+        uint32_t offset = address & PAGE_MASK;
+        if(offset > PAGE_SIZE - 4) return readWordSlow(address);
+        const uint8_t* page = findPage(address);
+        if(!page) return 0;
+        const uint8_t* p = page + offset;
+        if((offset & 0x3) == 0) return fromLittleEndian(__atomic_load_n(reinterpret_cast<const uint32_t*>(p), __ATOMIC_RELAXED));
+        return static_cast<uint32_t>(p[0])
+            | (static_cast<uint32_t>(p[1]) << 8)
+            | (static_cast<uint32_t>(p[2]) << 16)
+            | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    //Write a single byte
+    void writeByte(uint32_t address, uint8_t value){
+        getPage(address)[address & PAGE_MASK] = value;
+    }
+    //Write 4 bytes (little endian)
+    void writeWord(uint32_t address, uint32_t value){
+        uint32_t offset = address & PAGE_MASK;
+        if(offset > PAGE_SIZE - 4){
+            writeWordSlow(address, value);
+            return;
+        }
+        uint8_t* p = getPage(address) + offset;
+        if((offset & 0x3) == 0){
+            __atomic_store_n(reinterpret_cast<uint32_t*>(p), fromLittleEndian(value), __ATOMIC_RELAXED);
+            return;
+        }
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p[2] = static_cast<uint8_t>(value >> 16);
+        p[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    //Write a block of bytes, page by page
+    void writeBytes(uint32_t address, const uint8_t* data, size_t length);
+    //Copy length bytes from source to destination, page by page; the ranges may overlap (as with memmove),
+    //but not wrap around the address space
+    void copyBytes(uint32_t destination, uint32_t source, size_t length);
+    //Set length bytes from address on to value, page by page
+    void fillBytes(uint32_t address, uint8_t value, size_t length);
+
+    //Page holding the address, or nullptr if that page was never written
+    const uint8_t* findPage(uint32_t address) const{
+        const PageTable* table = directory[address >> (PAGE_BITS + TABLE_BITS)].load(std::memory_order_acquire);
+        if(!table) return nullptr;
+        const Page* page = (*table)[(address >> PAGE_BITS) & TABLE_MASK].page.load(std::memory_order_acquire);
+        return page ? page->bytes : nullptr;
+    }
+    //Page holding the address, to write into: allocated (zero-filled) if needed, or copied if it is shared
+    uint8_t* getPage(uint32_t address){
+        PageTable* table = directory[address >> (PAGE_BITS + TABLE_BITS)].load(std::memory_order_acquire);
+        if(table){
+            const PageSlot& slot = (*table)[(address >> PAGE_BITS) & TABLE_MASK];
+            Page* page = slot.page.load(std::memory_order_acquire);
+            //owner was set before page was published. A shared memory never replaces it afterwards: its pages
+            //are never shared copy-on-write, since the copy constructor refuses it, so use_count() stays 1
+            if(page && slot.owner.use_count() == 1) return page->bytes;
+        }
+        return allocatePage(address);
+    }
+
+    //Allow several threads to use this memory at once: pages are then allocated under a lock.
+    //Pages of a shared memory must not be shared copy-on-write as well: copying it afterwards throws std::logic_error.
+    void share(){
+        if(!allocationLock) allocationLock = std::make_unique<std::mutex>();
+    }
+
+    //Number of pages currently allocated
+    size_t pageCount() const { return allocatedPages; }
+
+    //Call visit(address, bytes) for every allocated page, in order of address
+    template<typename Visitor>
+    void forEachPage(Visitor visit) const{
+        for(uint32_t i = 0; i < TABLE_SIZE; i++){
+            if(!tables[i]) continue;
+            for(uint32_t j = 0; j < TABLE_SIZE; j++){
+                const Page* page = (*tables[i])[j].owner.get();
+                if(page) visit((i << (PAGE_BITS + TABLE_BITS)) | (j << PAGE_BITS), page->bytes);
+            }
+        }
+    }
+
+private:
+    //Each level of the table is indexed by 10 bits of the address
+    static constexpr uint32_t TABLE_BITS = 10;
+    static constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+    static constexpr uint32_t TABLE_MASK = TABLE_SIZE - 1;
+
+    struct Page{
+        uint8_t bytes[PAGE_SIZE];
+    };
+    //Pages are shared between copies, tables never are
+    struct PageSlot{
+        //Keeps the page alive; only changed while allocating
+        std::shared_ptr<Page> owner;
+        //The same page, for lookups, which may run while another thread allocates
+        std::atomic<Page*> page{nullptr};
+
+        PageSlot() = default;
+        PageSlot(const PageSlot& other) : owner(other.owner), page(other.owner.get()) {}
+    };
+    using PageTable = std::array<PageSlot, TABLE_SIZE>;
+
+    std::array<std::unique_ptr<PageTable>, TABLE_SIZE> tables;
+    //The same tables, for lookups
+    std::array<std::atomic<PageTable*>, TABLE_SIZE> directory{};
+    size_t allocatedPages = 0;
+    //Set by share(). Lookups don't take it: a table or page is only published (with a release store)
+    //once it is filled in, so a thread that loads the pointer (with acquire) sees its contents too
+    std::unique_ptr<std::mutex> allocationLock;
+
+    //Words are kept in memory little endian
+    static uint32_t fromLittleEndian(uint32_t value){
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return __builtin_bswap32(value);
+#else
+        return value;
+#endif
+    }
+
+    //Allocate the page holding the address, or replace it with a private copy if it is shared
+    uint8_t* allocatePage(uint32_t address);
+
+    //Byte-by-byte access for words that straddle two pages
+    uint32_t readWordSlow(uint32_t address) const;
+    void writeWordSlow(uint32_t address, uint32_t value);
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <ostream>
+#include "pagedMemory.hpp"
+#include "symbolMap.hpp"
+
+//Counts retired instructions per code address, and interrupts taken per cause.
+//With the call graph enabled, it also keeps a shadow call stack and counts retired instructions per call stack.
+class Profiler {
+public:
+    //Add count retired instructions to the instruction (or fused sequence) at the address
+    void retire(uint32_t address, uint64_t count){
+        uint32_t page = address >> PagedMemory::PAGE_BITS;
+        if(page != lastPage || !lastCounters) lastCounters = &counters(page);
+        (*lastCounters)[(address & PagedMemory::PAGE_MASK) >> 2] += count;
+        total += count;
+        if(callGraph) nodes[current].count += count;
+    }
+    //Count an interrupt taken with the cause, entering its handler
+    void interrupt(uint32_t cause, uint32_t handler){
+        if(cause < interrupts.size()) interrupts[cause]++;
+        if(callGraph) enter(static_cast<uint64_t>(cause) << 32 | handler);
+    }
+
+    void enableCallGraph(){ callGraph = true; }
+    //Entered a subroutine at the address
+    void call(uint32_t target){
+        if(callGraph) enter(target);
+    }
+    //Returned from a subroutine or an interrupt handler
+    void ret(){
+        if(callGraph && current != 0) current = nodes[current].parent;
+    }
+
+    //Write the report, hottest addresses first; symbols may be nullptr
+    void writeReport(std::ostream& out, const SymbolMap* symbols) const;
+    //Write one line per call stack: its frames from the outermost one, separated by ';', and the instructions it retired
+    void writeFoldedStacks(std::ostream& out, const SymbolMap* symbols) const;
+
+private:
+    //One counter per 4-byte aligned address of a page
+    using Counters = std::array<uint64_t, PagedMemory::PAGE_SIZE / 4>;
+    std::unordered_map<uint32_t, std::unique_ptr<Counters>> pages;
+    //Counters of the page retire() used last, code runs within one page most of the time
+    uint32_t lastPage = 0;
+    Counters* lastCounters = nullptr;
+    uint64_t total = 0;
+    //Indexed by cause
+    std::array<uint64_t, 8> interrupts = {};
+
+    Counters& counters(uint32_t page);
+
+    /*--- Call graph ---*/
+    ///
+    //Every call stack seen is a node of a tree, nodes[0] being the bottom of the stack
+    struct Node{
+        //Entry address, with the cause of the interrupt above bit 32 for handlers
+        uint64_t frame;
+        uint32_t parent;
+        //Instructions retired while this was the call stack
+        uint64_t count;
+        std::unordered_map<uint64_t, uint32_t> children;
+    };
+    bool callGraph = false;
+    std::vector<Node> nodes = {Node{0, 0, 0, {}}};
+    uint32_t current = 0;
+    void enter(uint64_t frame);
+    std::string frameName(uint64_t frame, const SymbolMap* symbols) const;
+};
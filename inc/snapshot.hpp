@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+//Snapshot of the emulated machine: the header, then pageCount pages that aren't all zeros,
+//each one a uint32_t address followed by the page's 4 KiB
+struct SnapshotHeader {
+    uint8_t magic[8];
+    uint64_t instructionCount;
+    //Virtual clock rate the snapshot was taken at, and the virtual timer's next deadline
+    uint64_t virtualRate;
+    uint64_t timerDeadline;
+    int32_t gpr[16];
+    int32_t csr[3];
+    uint32_t tim_cfg;
+    uint32_t term_in;
+    uint32_t dmaAddress;
+    uint32_t dmaLength;
+    uint32_t pendingInterrupts;
+    uint32_t flags;
+    uint32_t pageCount;
+};
+
+enum SnapshotFlags : uint32_t {
+    SNAPSHOT_TIMER_STARTED     = 0x1,
+    SNAPSHOT_HANDLER_INSTALLED = 0x2,
+    //Taken after the processor halted: there is nothing left to run
+    SNAPSHOT_HALTED            = 0x4
+};
+
+constexpr uint8_t SNAPSHOT_MAGIC[8] = {'S', 'H', 'S', 'N', 'A', 'P', 0, 3};
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <algorithm>
+
+//Bounded lock-free queue between exactly one producer thread and exactly one consumer thread.
+//Each side keeps a cached copy of the other side's index, so the shared cache lines are only
+//touched when the ring looks full (producer) or empty (consumer).
+template<typename T, size_t SIZE>
+class SpscRing{
+public:
+    static_assert(SIZE != 0 && (SIZE & (SIZE - 1)) == 0, "SpscRing size has to be a power of two");
+
+    /*--- Producer side ---*/
+    ///
+    //Add an element; returns false if the ring is full
+    bool push(const T& value){
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t - headCache == SIZE){
+            headCache = head.load(std::memory_order_acquire);
+            if(t - headCache == SIZE) return false;
+        }
+        buffer[t & MASK] = value;
+        //seq_cst pairs with the consumer's pop(), see consumerIdle()
+        tail.store(t + 1, std::memory_order_seq_cst);
+        return true;
+    }
+    //Add as many of count elements as there is room for; returns how many were added
+    size_t push(const T* values, size_t count){
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(SIZE - (t - headCache) < count) headCache = head.load(std::memory_order_acquire);
+        size_t n = std::min(count, SIZE - (t - headCache));
+        //The free space may wrap around the end of the buffer
+        size_t first = std::min(n, SIZE - (t & MASK));
+        std::copy(values, values + first, buffer.begin() + (t & MASK));
+        std::copy(values + first, values + n, buffer.begin());
+        tail.store(t + n, std::memory_order_seq_cst);
+        return n;
+    }
+    //Call after a push of pushed elements: true if the consumer had taken everything pushed before it, so it may be
+    //waiting for more and has to be woken up. Can be true when it doesn't have to, never the other way round.
+    bool consumerIdle(size_t pushed = 1) const{
+        return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_seq_cst) <= pushed;
+    }
+    //Number of elements that can be pushed without failing
+    size_t freeSpace(){
+        headCache = head.load(std::memory_order_acquire);
+        return SIZE - (tail.load(std::memory_order_relaxed) - headCache);
+    }
+
+    /*--- Consumer side ---*/
+    ///
+    //Take the oldest element; returns false if the ring is empty
+    bool pop(T& value){
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h == tailCache){
+            tailCache = tail.load(std::memory_order_seq_cst);
+            if(h == tailCache) return false;
+        }
+        value = buffer[h & MASK];
+        head.store(h + 1, std::memory_order_seq_cst);
+        return true;
+    }
+    bool empty() const{
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_seq_cst);
+    }
+
+private:
+    static constexpr size_t MASK = SIZE - 1;
+    static constexpr size_t CACHE_LINE = 64;
+
+    //Written by the producer
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};
+    size_t headCache = 0;
+    //Written by the consumer
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};
+    size_t tailCache = 0;
+
+    alignas(CACHE_LINE) std::array<T, SIZE> buffer;
+};
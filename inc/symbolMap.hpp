@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//Addresses of sections and symbols, as written by the linker (-map), used to name code addresses in reports.
+class SymbolMap {
+public:
+    //Read given file
+    explicit SymbolMap(const std::string& filename);
+
+    struct Section{
+        uint32_t address;
+        uint32_t size;
+        std::string name;
+    };
+    struct Symbol{
+        uint32_t address;
+        std::string section;
+        std::string name;
+    };
+
+    //Section holding the address, or nullptr
+    const Section* sectionAt(uint32_t address) const;
+    //Last symbol at or before the address in the section holding it, or nullptr
+    const Symbol* symbolAt(uint32_t address) const;
+    //"symbol+0xoffset", or the address in hex if no symbol holds it
+    std::string describe(uint32_t address) const;
+
+private:
+    //Both sorted by address
+    std::vector<Section> sections;
+    std::vector<Symbol> symbols;
+
+    void parseFile(const std::string& filename);
+};
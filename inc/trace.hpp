@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+//Execution trace written by the emulator (-trace): the header, then count entries, oldest first
+struct TraceHeader {
+    uint8_t magic[8];
+    //Instructions traced in the whole run; the file holds the last count of them
+    uint64_t recorded;
+    uint32_t count;
+    uint32_t entrySize;
+};
+
+//One executed instruction, or fused sequence
+struct TraceEntry {
+    uint32_t pc;
+    //Instruction word at pc (the first word of a fused sequence)
+    uint32_t instruction;
+    //Value of the register the instruction wrote, or the value it stored
+    uint32_t value;
+    //Memory address the instruction read or wrote, 0 if none
+    uint32_t address;
+};
+
+constexpr uint8_t TRACE_MAGIC[8] = {'S', 'H', 'T', 'R', 'A', 'C', 'E', 1};
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+#include "trace.hpp"
+#include "symbolMap.hpp"
+
+//Turns an execution trace written by the emulator (-trace) into text, one line per executed instruction.
+class TraceDump{
+public:
+    TraceDump(){}
+    //Read the trace
+    void readFile(const std::string& filename);
+    //Name code addresses after the symbols in a map written by the linker
+    void setSymbolMap(const std::string& mapFile);
+
+    //Print the last entries of the trace (all of them if last is 0), oldest first
+    void print(std::ostream& out, size_t last) const;
+
+private:
+    TraceHeader header;
+    std::vector<TraceEntry> entries;
+    std::unique_ptr<SymbolMap> symbols;
+
+    //What the instruction does, in the notation of the instruction set description
+    static std::string disassemble(uint32_t instruction);
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "trace.hpp"
+
+//Keeps the last entries recorded in memory, overwriting the oldest ones.
+//Only the CPU thread records, so recording is a plain store without locks or atomics.
+class TraceRing {
+public:
+    //The capacity is rounded up to a power of two
+    explicit TraceRing(size_t capacity);
+
+    //Record an instruction about to execute; its value is filled in once it did
+    TraceEntry& record(uint32_t pc, uint32_t instruction, uint32_t address){
+        TraceEntry& entry = entries[recorded++ & mask];
+        entry = {pc, instruction, 0, address};
+        return entry;
+    }
+
+    //Write the entries held, oldest first
+    void write(const std::string& filename) const;
+
+private:
+    std::vector<TraceEntry> entries;
+    size_t mask;
+    //Entries recorded since the start
+    uint64_t recorded = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
+#include <ostream>
+#include <memory>
+#include "imageReader.hpp"
+
+//Ahead-of-time translator: turns the code reachable in an executable produced by the linker (hex mode)
+//into a C++ translation unit, one function per basic block, to be compiled and linked with the emulator library.
+class Translator{
+public:
+    Translator(){}
+    //Read the executable
+    void readFile(const std::string& filename);
+
+    //Add an address where execution may start, besides the initial PC and interrupt handlers found in the code
+    void addEntryPoint(uint32_t address);
+
+    //Generate the C++ source
+    void translate(const std::string& outputFilename);
+
+private:
+    //Initial PC value
+    static constexpr uint32_t START_ADDRESS = 0x40000000;
+    static constexpr uint32_t MMIO_START = 0xFFFFFF00;
+
+    /*--- Indexes of special GPRs ---*/
+    ///
+    static constexpr uint8_t PC = 15;
+    static constexpr uint8_t SP = 14;
+    //Writes into r0 go to r[SINK] in the generated code
+    static constexpr uint8_t SINK = 16;
+
+    struct Instruction{
+        //Address of the instruction; PC holds address + 4 while it executes
+        uint32_t address;
+        uint32_t word;
+        uint8_t oc;
+        uint8_t mod;
+        uint8_t a;
+        uint8_t b;
+        uint8_t c;
+        int32_t disp;
+    };
+    //Straight-line code inside one page, ending at the first instruction that may change PC
+    //in a way that isn't known while translating
+    struct Block{
+        std::vector<Instruction> instructions;
+    };
+
+    //Keeps the contents of the segments
+    std::unique_ptr<ImageReader> image;
+    std::vector<ImageReader::Segment> segments;
+    std::set<uint32_t> entryPoints;
+    std::map<uint32_t, Block> blocks;
+
+    //True if the 4 bytes at the address are part of the image
+    bool isLoaded(uint32_t address) const;
+    uint32_t readWord(uint32_t address) const;
+    //Literal read by an instruction at the address, if it is known while translating
+    //(inside the image, in the same page as the instruction, so a write that changes it stops native code)
+    bool knownLiteral(const Instruction& in, uint32_t literalAddress, uint32_t& value) const;
+
+    static Instruction decode(uint32_t address, uint32_t word);
+    //True if the operand fields are not allowed by the instruction's encoding
+    static bool hasIllegalFields(const Instruction& in);
+
+    //Find the blocks reachable from the entry points
+    void discoverBlocks();
+    //Add instructions to the block until one that ends it; successors gets the addresses known to follow it
+    void formBlock(uint32_t start, Block& block, std::vector<uint32_t>& successors) const;
+    //True if the block goes on after the instruction; nextAddress is where
+    bool continuesBlock(const Instruction& in, uint32_t& nextAddress, std::vector<uint32_t>& successors) const;
+
+    void emitBlock(std::ostream& out, uint32_t start, const Block& block) const;
+    //Emit the statements of a single instruction, the retired-th of its block;
+    //returns false if control never falls through them
+    bool emitInstruction(std::ostream& out, const Instruction& in, size_t retired) const;
+    void emitImage(std::ostream& out) const;
+};
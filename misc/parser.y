@@ -46,8 +46,10 @@ void yyerror(const char *s) {
 %token GLOBAL EXTERN SECTION WORD SKIP END ASCII EQU
 
 /*Commands*/
-%token HALT INT IRET CALL RET JMP BEQ BNE BGT
+%token HALT INT IRET WAIT CALL RET JMP BEQ BNE BGT
 %token PUSH POP XCHG ADD SUB MUL DIV NOT AND OR XOR SHL SHR
+%token COPY FILL
+%token PADDB PSUBB PCMPEQB PCMPGTB PMINB PMAXB PADDH PSUBH PCMPEQH PCMPGTH PMINH PMAXH PSHUFB
 %token LD ST CSRRD CSRWR
 
 /*Punctuation*/
@@ -261,6 +263,9 @@ command:
     | IRET {
         assembler.processInstruction("iret", {});
     }
+    | WAIT {
+        assembler.processInstruction("wait", {});
+    }
     | CALL jmpOperand {
         std::string mnemonic = "call" + (*$2)[0];
         $2->erase($2->begin());
@@ -345,6 +350,51 @@ command:
     | SHR GPR COMMA GPR {
         assembler.processInstruction("shr", {std::to_string($2), std::to_string($4) });
     }
+    | COPY GPR COMMA GPR COMMA GPR {
+        assembler.processInstruction("copy", {std::to_string($2), std::to_string($4), std::to_string($6) });
+    }
+    | FILL GPR COMMA GPR COMMA GPR {
+        assembler.processInstruction("fill", {std::to_string($2), std::to_string($4), std::to_string($6) });
+    }
+    | PADDB GPR COMMA GPR {
+        assembler.processInstruction("paddb", {std::to_string($2), std::to_string($4) });
+    }
+    | PSUBB GPR COMMA GPR {
+        assembler.processInstruction("psubb", {std::to_string($2), std::to_string($4) });
+    }
+    | PCMPEQB GPR COMMA GPR {
+        assembler.processInstruction("pcmpeqb", {std::to_string($2), std::to_string($4) });
+    }
+    | PCMPGTB GPR COMMA GPR {
+        assembler.processInstruction("pcmpgtb", {std::to_string($2), std::to_string($4) });
+    }
+    | PMINB GPR COMMA GPR {
+        assembler.processInstruction("pminb", {std::to_string($2), std::to_string($4) });
+    }
+    | PMAXB GPR COMMA GPR {
+        assembler.processInstruction("pmaxb", {std::to_string($2), std::to_string($4) });
+    }
+    | PADDH GPR COMMA GPR {
+        assembler.processInstruction("paddh", {std::to_string($2), std::to_string($4) });
+    }
+    | PSUBH GPR COMMA GPR {
+        assembler.processInstruction("psubh", {std::to_string($2), std::to_string($4) });
+    }
+    | PCMPEQH GPR COMMA GPR {
+        assembler.processInstruction("pcmpeqh", {std::to_string($2), std::to_string($4) });
+    }
+    | PCMPGTH GPR COMMA GPR {
+        assembler.processInstruction("pcmpgth", {std::to_string($2), std::to_string($4) });
+    }
+    | PMINH GPR COMMA GPR {
+        assembler.processInstruction("pminh", {std::to_string($2), std::to_string($4) });
+    }
+    | PMAXH GPR COMMA GPR {
+        assembler.processInstruction("pmaxh", {std::to_string($2), std::to_string($4) });
+    }
+    | PSHUFB GPR COMMA GPR {
+        assembler.processInstruction("pshufb", {std::to_string($2), std::to_string($4) });
+    }
     | LD loadOperand COMMA GPR {
         std::string mnemonic = (*$2)[0];
         $2->erase($2->begin());
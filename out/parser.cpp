@@ -0,0 +1,2360 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "misc/parser.y"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "assembler.hpp"
+#include "expression.hpp"
+#include "numberExpr.hpp"
+#include "symbolExpr.hpp"
+#include "unaryExpr.hpp"
+#include "binaryExpr.hpp"
+
+extern int yylex();
+extern int yyparse();
+extern FILE *yyin;
+Assembler assembler;
+
+int currentLine = 1;
+
+void yyerror(const char *s) {
+    fprintf(stderr, "Parse error: %s at line: %d\n", s, currentLine);
+}
+
+#line 96 "out/parser.cpp"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "parser.hpp"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_GPR = 3,                        /* GPR  */
+  YYSYMBOL_CSR = 4,                        /* CSR  */
+  YYSYMBOL_NUMBER = 5,                     /* NUMBER  */
+  YYSYMBOL_CHAR = 6,                       /* CHAR  */
+  YYSYMBOL_SYMBOL = 7,                     /* SYMBOL  */
+  YYSYMBOL_STRING = 8,                     /* STRING  */
+  YYSYMBOL_GLOBAL = 9,                     /* GLOBAL  */
+  YYSYMBOL_EXTERN = 10,                    /* EXTERN  */
+  YYSYMBOL_SECTION = 11,                   /* SECTION  */
+  YYSYMBOL_WORD = 12,                      /* WORD  */
+  YYSYMBOL_SKIP = 13,                      /* SKIP  */
+  YYSYMBOL_END = 14,                       /* END  */
+  YYSYMBOL_ASCII = 15,                     /* ASCII  */
+  YYSYMBOL_EQU = 16,                       /* EQU  */
+  YYSYMBOL_HALT = 17,                      /* HALT  */
+  YYSYMBOL_INT = 18,                       /* INT  */
+  YYSYMBOL_IRET = 19,                      /* IRET  */
+  YYSYMBOL_WAIT = 20,                      /* WAIT  */
+  YYSYMBOL_CALL = 21,                      /* CALL  */
+  YYSYMBOL_RET = 22,                       /* RET  */
+  YYSYMBOL_JMP = 23,                       /* JMP  */
+  YYSYMBOL_BEQ = 24,                       /* BEQ  */
+  YYSYMBOL_BNE = 25,                       /* BNE  */
+  YYSYMBOL_BGT = 26,                       /* BGT  */
+  YYSYMBOL_PUSH = 27,                      /* PUSH  */
+  YYSYMBOL_POP = 28,                       /* POP  */
+  YYSYMBOL_XCHG = 29,                      /* XCHG  */
+  YYSYMBOL_ADD = 30,                       /* ADD  */
+  YYSYMBOL_SUB = 31,                       /* SUB  */
+  YYSYMBOL_MUL = 32,                       /* MUL  */
+  YYSYMBOL_DIV = 33,                       /* DIV  */
+  YYSYMBOL_NOT = 34,                       /* NOT  */
+  YYSYMBOL_AND = 35,                       /* AND  */
+  YYSYMBOL_OR = 36,                        /* OR  */
+  YYSYMBOL_XOR = 37,                       /* XOR  */
+  YYSYMBOL_SHL = 38,                       /* SHL  */
+  YYSYMBOL_SHR = 39,                       /* SHR  */
+  YYSYMBOL_COPY = 40,                      /* COPY  */
+  YYSYMBOL_FILL = 41,                      /* FILL  */
+  YYSYMBOL_PADDB = 42,                     /* PADDB  */
+  YYSYMBOL_PSUBB = 43,                     /* PSUBB  */
+  YYSYMBOL_PCMPEQB = 44,                   /* PCMPEQB  */
+  YYSYMBOL_PCMPGTB = 45,                   /* PCMPGTB  */
+  YYSYMBOL_PMINB = 46,                     /* PMINB  */
+  YYSYMBOL_PMAXB = 47,                     /* PMAXB  */
+  YYSYMBOL_PADDH = 48,                     /* PADDH  */
+  YYSYMBOL_PSUBH = 49,                     /* PSUBH  */
+  YYSYMBOL_PCMPEQH = 50,                   /* PCMPEQH  */
+  YYSYMBOL_PCMPGTH = 51,                   /* PCMPGTH  */
+  YYSYMBOL_PMINH = 52,                     /* PMINH  */
+  YYSYMBOL_PMAXH = 53,                     /* PMAXH  */
+  YYSYMBOL_PSHUFB = 54,                    /* PSHUFB  */
+  YYSYMBOL_LD = 55,                        /* LD  */
+  YYSYMBOL_ST = 56,                        /* ST  */
+  YYSYMBOL_CSRRD = 57,                     /* CSRRD  */
+  YYSYMBOL_CSRWR = 58,                     /* CSRWR  */
+  YYSYMBOL_DOLLAR = 59,                    /* DOLLAR  */
+  YYSYMBOL_COLON = 60,                     /* COLON  */
+  YYSYMBOL_COMMA = 61,                     /* COMMA  */
+  YYSYMBOL_LBRACKET = 62,                  /* LBRACKET  */
+  YYSYMBOL_RBRACKET = 63,                  /* RBRACKET  */
+  YYSYMBOL_PLUS = 64,                      /* PLUS  */
+  YYSYMBOL_MINUS = 65,                     /* MINUS  */
+  YYSYMBOL_LPAREN = 66,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 67,                    /* RPAREN  */
+  YYSYMBOL_NEWLINE = 68,                   /* NEWLINE  */
+  YYSYMBOL_YYACCEPT = 69,                  /* $accept  */
+  YYSYMBOL_file = 70,                      /* file  */
+  YYSYMBOL_lastLine = 71,                  /* lastLine  */
+  YYSYMBOL_lines = 72,                     /* lines  */
+  YYSYMBOL_line = 73,                      /* line  */
+  YYSYMBOL_label = 74,                     /* label  */
+  YYSYMBOL_directive = 75,                 /* directive  */
+  YYSYMBOL_globalDir = 76,                 /* globalDir  */
+  YYSYMBOL_externDir = 77,                 /* externDir  */
+  YYSYMBOL_sectionDir = 78,                /* sectionDir  */
+  YYSYMBOL_wordDir = 79,                   /* wordDir  */
+  YYSYMBOL_skipDir = 80,                   /* skipDir  */
+  YYSYMBOL_endDir = 81,                    /* endDir  */
+  YYSYMBOL_asciiDir = 82,                  /* asciiDir  */
+  YYSYMBOL_equDir = 83,                    /* equDir  */
+  YYSYMBOL_expression = 84,                /* expression  */
+  YYSYMBOL_term = 85,                      /* term  */
+  YYSYMBOL_factor = 86,                    /* factor  */
+  YYSYMBOL_symbol_list = 87,               /* symbol_list  */
+  YYSYMBOL_symbol_literal_list = 88,       /* symbol_literal_list  */
+  YYSYMBOL_symbol_or_literal = 89,         /* symbol_or_literal  */
+  YYSYMBOL_literal = 90,                   /* literal  */
+  YYSYMBOL_command = 91,                   /* command  */
+  YYSYMBOL_jmpOperand = 92,                /* jmpOperand  */
+  YYSYMBOL_loadOperand = 93,               /* loadOperand  */
+  YYSYMBOL_storeOperand = 94               /* storeOperand  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   300
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  69
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  26
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  106
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  246
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   323
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
+      65,    66,    67,    68
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,    67,    67,    68,    70,    71,    72,    73,    74,    77,
+      79,    82,    83,    84,    85,    86,    87,    91,   100,   101,
+     102,   103,   104,   105,   106,   107,   111,   117,   123,   132,
+     138,   146,   151,   158,   166,   169,   172,   178,   181,   187,
+     190,   195,   203,   208,   216,   222,   231,   236,   246,   249,
+     257,   260,   263,   266,   269,   275,   278,   284,   294,   304,
+     314,   317,   320,   323,   326,   329,   332,   335,   338,   341,
+     344,   347,   350,   353,   356,   359,   362,   365,   368,   371,
+     374,   377,   380,   383,   386,   389,   392,   395,   398,   406,
+     414,   417,   425,   430,   439,   444,   450,   455,   461,   466,
+     471,   477,   487,   492,   498,   503,   509
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "GPR", "CSR", "NUMBER",
+  "CHAR", "SYMBOL", "STRING", "GLOBAL", "EXTERN", "SECTION", "WORD",
+  "SKIP", "END", "ASCII", "EQU", "HALT", "INT", "IRET", "WAIT", "CALL",
+  "RET", "JMP", "BEQ", "BNE", "BGT", "PUSH", "POP", "XCHG", "ADD", "SUB",
+  "MUL", "DIV", "NOT", "AND", "OR", "XOR", "SHL", "SHR", "COPY", "FILL",
+  "PADDB", "PSUBB", "PCMPEQB", "PCMPGTB", "PMINB", "PMAXB", "PADDH",
+  "PSUBH", "PCMPEQH", "PCMPGTH", "PMINH", "PMAXH", "PSHUFB", "LD", "ST",
+  "CSRRD", "CSRWR", "DOLLAR", "COLON", "COMMA", "LBRACKET", "RBRACKET",
+  "PLUS", "MINUS", "LPAREN", "RPAREN", "NEWLINE", "$accept", "file",
+  "lastLine", "lines", "line", "label", "directive", "globalDir",
+  "externDir", "sectionDir", "wordDir", "skipDir", "endDir", "asciiDir",
+  "equDir", "expression", "term", "factor", "symbol_list",
+  "symbol_literal_list", "symbol_or_literal", "literal", "command",
+  "jmpOperand", "loadOperand", "storeOperand", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-191)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -191,    33,    35,  -191,   -55,    25,    25,    34,     2,    17,
+    -191,    88,    95,  -191,  -191,  -191,  -191,     5,  -191,     5,
+      37,   104,   105,   106,   107,   108,   110,   111,   112,   113,
+     114,   115,   116,   117,   118,   119,   120,   121,   124,   125,
+     126,   127,   128,   129,   130,   131,   132,   133,   134,   135,
+     136,    94,   137,   138,   140,  -191,  -191,  -191,   225,    73,
+    -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,    76,  -191,
+    -191,    84,    84,  -191,  -191,  -191,  -191,    85,  -191,  -191,
+    -191,  -191,    86,  -191,  -191,  -191,  -191,    87,    89,    90,
+    -191,  -191,    91,    93,    96,    97,   101,  -191,   102,   103,
+     109,   122,   123,   139,   142,   143,   147,   148,   149,   150,
+     153,   154,   155,   156,   157,   158,   159,   160,  -191,  -191,
+       8,   146,  -191,   161,   162,   163,   164,  -191,    92,    98,
+    -191,  -191,   165,     2,    29,   152,   166,   168,   170,   171,
+     172,   173,   174,   175,   176,   177,   178,   179,   182,   183,
+     184,   185,   186,   187,   188,   189,   190,   191,   192,   193,
+     194,   195,   196,  -191,  -191,   -39,   198,    99,   223,   224,
+    -191,  -191,  -191,  -191,  -191,    32,    29,   -38,  -191,  -191,
+    -191,   169,   226,   227,  -191,  -191,  -191,  -191,  -191,  -191,
+    -191,  -191,  -191,  -191,   228,   229,  -191,  -191,  -191,  -191,
+    -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,
+      11,  -191,  -191,   281,  -191,  -191,  -191,  -191,  -191,   -61,
+      29,    29,     5,     5,     5,   282,   283,   231,   232,   -35,
+    -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,  -191,
+    -191,    14,   233,   234,  -191,  -191
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       9,     0,     3,     1,     0,     0,     0,     0,     0,     0,
+      31,     0,     0,    50,    51,    52,    53,     0,    55,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    16,     2,    10,     4,     8,
+      18,    19,    20,    21,    22,    23,    24,    25,     7,    17,
+      42,    26,    27,    28,    48,    49,    46,    29,    44,    47,
+      30,    32,     0,    93,    92,    54,    56,     0,     0,     0,
+      60,    61,     0,     0,     0,     0,     0,    67,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    98,    97,
+       0,     0,    96,     0,     0,     0,     0,    11,     6,     5,
+      15,    14,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    95,    94,     0,     0,     0,     0,     0,
+      13,    12,    43,    45,    40,     0,     0,    33,    34,    37,
+      39,     0,     0,     0,    62,    63,    64,    65,    66,    68,
+      69,    70,    71,    72,     0,     0,    75,    76,    77,    78,
+      79,    80,    81,    82,    83,    84,    85,    86,    87,    99,
+       0,    88,   103,     0,   102,    89,    90,    91,    38,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      41,    35,    36,    57,    58,    59,    73,    74,   101,   100,
+     104,     0,     0,     0,   106,   105
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -191,  -191,  -191,  -191,  -191,  -191,   240,  -191,  -191,  -191,
+    -191,  -191,  -191,  -191,  -191,   -11,  -190,    52,   285,  -191,
+     167,    -8,   241,   -17,  -191,  -191
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
+{
+       0,     1,    56,     2,    57,    58,    59,    60,    61,    62,
+      63,    64,    65,    66,    67,   177,   178,   179,    71,    77,
+      78,    84,    68,    85,   123,   215
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_uint8 yytable[] =
+{
+      79,    80,    86,   220,   221,    69,   230,    74,    75,    76,
+      74,    75,    83,    74,    75,   163,    74,    75,   227,    74,
+      75,   242,    74,    75,   209,   210,   220,   221,   240,   241,
+     231,   232,    70,     3,    74,    75,   174,    74,    75,   174,
+      87,    73,     4,   122,     5,     6,     7,     8,     9,    10,
+      11,    12,    13,    14,    15,    16,    17,    18,    19,    20,
+      21,    22,    23,    24,    25,    26,    27,    28,    29,    30,
+      31,    32,    33,    34,    35,    36,    37,    38,    39,    40,
+      41,    42,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    52,    53,    54,   175,   176,    81,   118,   176,    74,
+      75,   119,    82,    55,    74,    75,   212,    88,    89,    90,
+      91,    92,   164,    93,    94,    95,    96,    97,    98,    99,
+     100,   101,   102,   103,   104,    79,   180,   105,   106,   107,
+     108,   109,   110,   111,   112,   113,   114,   115,   116,   117,
+     124,   130,   125,   126,   131,   132,   133,   134,   135,   165,
+     136,   137,   138,   120,   139,   181,   121,   140,   141,   214,
+     170,   213,   142,   143,   144,   219,   171,   180,   180,   182,
+     145,   183,   172,   184,   185,   186,   187,   188,   189,   190,
+     191,   192,   193,   146,   147,   194,   195,   196,   197,   198,
+     199,   200,   201,   202,   203,   204,   205,   206,   207,   208,
+     148,   211,   228,   149,   150,   233,   234,   235,   151,   152,
+     153,   154,   180,   180,   155,   156,   157,   158,   159,   160,
+     161,   162,   166,   167,   168,   169,   216,   218,   217,     0,
+     222,     0,     0,   243,     5,     6,     7,     8,     9,    10,
+      11,    12,    13,    14,    15,    16,    17,    18,    19,    20,
+      21,    22,    23,    24,    25,    26,    27,    28,    29,    30,
+      31,    32,    33,    34,    35,    36,    37,    38,    39,    40,
+      41,    42,    43,    44,    45,    46,    47,    48,    49,    50,
+      51,    52,    53,    54,   229,   236,   237,   223,   224,   225,
+     226,    72,     0,   127,   238,   239,   244,   245,   128,   129,
+     173
+};
+
+static const yytype_int16 yycheck[] =
+{
+       8,     9,    19,    64,    65,    60,    67,     5,     6,     7,
+       5,     6,     7,     5,     6,     7,     5,     6,     7,     5,
+       6,     7,     5,     6,    63,    64,    64,    65,    63,    64,
+     220,   221,     7,     0,     5,     6,     7,     5,     6,     7,
+       3,     7,     7,    51,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    65,    66,     8,     3,    66,     5,
+       6,     7,     7,    68,     5,     6,     7,     3,     3,     3,
+       3,     3,   120,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,   133,   134,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,    68,     4,     3,    68,    61,    61,    61,    61,     3,
+      61,    61,    61,    59,    61,     3,    62,    61,    61,   167,
+      68,    62,    61,    61,    61,   176,    68,   175,   176,     3,
+      61,     3,     7,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,    61,    61,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+      61,     3,   210,    61,    61,   222,   223,   224,    61,    61,
+      61,    61,   220,   221,    61,    61,    61,    61,    61,    61,
+      61,    61,    61,    61,    61,    61,     3,   175,     4,    -1,
+      61,    -1,    -1,   241,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,     3,     3,     3,    61,    61,    61,
+      61,     6,    -1,    68,    63,    63,    63,    63,    58,    58,
+     133
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    70,    72,     0,     7,     9,    10,    11,    12,    13,
+      14,    15,    16,    17,    18,    19,    20,    21,    22,    23,
+      24,    25,    26,    27,    28,    29,    30,    31,    32,    33,
+      34,    35,    36,    37,    38,    39,    40,    41,    42,    43,
+      44,    45,    46,    47,    48,    49,    50,    51,    52,    53,
+      54,    55,    56,    57,    58,    68,    71,    73,    74,    75,
+      76,    77,    78,    79,    80,    81,    82,    83,    91,    60,
+       7,    87,    87,     7,     5,     6,     7,    88,    89,    90,
+      90,     8,     7,     7,    90,    92,    92,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     7,
+      59,    62,    90,    93,     3,     4,     3,    68,    75,    91,
+      68,    68,    61,    61,    61,    61,    61,    61,    61,    61,
+      61,    61,    61,    61,    61,    61,    61,    61,    61,    61,
+      61,    61,    61,    61,    61,    61,    61,    61,    61,    61,
+      61,    61,    61,     7,    90,     3,    61,    61,    61,    61,
+      68,    68,     7,    89,     7,    65,    66,    84,    85,    86,
+      90,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,    63,
+      64,     3,     7,    62,    90,    94,     3,     4,    86,    84,
+      64,    65,    61,    61,    61,    61,    61,     7,    90,     3,
+      67,    85,    85,    92,    92,    92,     3,     3,    63,    63,
+      63,    64,     7,    90,    63,    63
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    69,    70,    70,    71,    71,    71,    71,    71,    72,
+      72,    73,    73,    73,    73,    73,    73,    74,    75,    75,
+      75,    75,    75,    75,    75,    75,    76,    77,    78,    79,
+      80,    81,    82,    83,    84,    84,    84,    85,    85,    86,
+      86,    86,    87,    87,    88,    88,    89,    89,    90,    90,
+      91,    91,    91,    91,    91,    91,    91,    91,    91,    91,
+      91,    91,    91,    91,    91,    91,    91,    91,    91,    91,
+      91,    91,    91,    91,    91,    91,    91,    91,    91,    91,
+      91,    91,    91,    91,    91,    91,    91,    91,    91,    91,
+      91,    91,    92,    92,    93,    93,    93,    93,    93,    93,
+      93,    93,    94,    94,    94,    94,    94
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     2,     1,     1,     2,     2,     1,     1,     0,
+       2,     2,     3,     3,     2,     2,     1,     2,     1,     1,
+       1,     1,     1,     1,     1,     1,     2,     2,     2,     2,
+       2,     1,     2,     4,     1,     3,     3,     1,     2,     1,
+       1,     3,     1,     3,     1,     3,     1,     1,     1,     1,
+       1,     1,     1,     1,     2,     1,     2,     6,     6,     6,
+       2,     2,     4,     4,     4,     4,     4,     2,     4,     4,
+       4,     4,     4,     6,     6,     4,     4,     4,     4,     4,
+       4,     4,     4,     4,     4,     4,     4,     4,     4,     4,
+       4,     4,     1,     1,     2,     2,     1,     1,     1,     3,
+       5,     5,     1,     1,     3,     5,     5
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 17: /* label: SYMBOL COLON  */
+#line 91 "misc/parser.y"
+                 {
+        assembler.defineLabel((yyvsp[-1].sval));
+        free((yyvsp[-1].sval));
+    }
+#line 1351 "out/parser.cpp"
+    break;
+
+  case 26: /* globalDir: GLOBAL symbol_list  */
+#line 111 "misc/parser.y"
+                       { 
+        assembler.processDirective(".global", *(yyvsp[0].slist));
+    }
+#line 1359 "out/parser.cpp"
+    break;
+
+  case 27: /* externDir: EXTERN symbol_list  */
+#line 117 "misc/parser.y"
+                       { 
+        assembler.processDirective(".extern", *(yyvsp[0].slist));
+    }
+#line 1367 "out/parser.cpp"
+    break;
+
+  case 28: /* sectionDir: SECTION SYMBOL  */
+#line 123 "misc/parser.y"
+                   {
+        std::vector<std::string> args;
+        args.push_back((yyvsp[0].sval));
+        assembler.processDirective(".section", args);
+        free((yyvsp[0].sval));
+    }
+#line 1378 "out/parser.cpp"
+    break;
+
+  case 29: /* wordDir: WORD symbol_literal_list  */
+#line 132 "misc/parser.y"
+                             { 
+        assembler.processDirective(".word", *(yyvsp[0].slist));
+    }
+#line 1386 "out/parser.cpp"
+    break;
+
+  case 30: /* skipDir: SKIP literal  */
+#line 138 "misc/parser.y"
+                 {
+        std::vector<std::string> args;
+        args.push_back(std::to_string((yyvsp[0].ival)));
+        assembler.processDirective(".skip", args);
+    }
+#line 1396 "out/parser.cpp"
+    break;
+
+  case 31: /* endDir: END  */
+#line 146 "misc/parser.y"
+        { 
+        assembler.processDirective(".end", {});
+    }
+#line 1404 "out/parser.cpp"
+    break;
+
+  case 32: /* asciiDir: ASCII STRING  */
+#line 151 "misc/parser.y"
+                 {
+        std::vector<std::string> args;
+        args.push_back((yyvsp[0].sval));
+        assembler.processDirective(".ascii", args);
+        free((yyvsp[0].sval));
+    }
+#line 1415 "out/parser.cpp"
+    break;
+
+  case 33: /* equDir: EQU SYMBOL COMMA expression  */
+#line 158 "misc/parser.y"
+                                {
+        assembler.processEqu((yyvsp[-2].sval), (yyvsp[0].expr));
+        free((yyvsp[-2].sval));
+    }
+#line 1424 "out/parser.cpp"
+    break;
+
+  case 34: /* expression: term  */
+#line 166 "misc/parser.y"
+         { 
+        (yyval.expr) = (yyvsp[0].expr); 
+    }
+#line 1432 "out/parser.cpp"
+    break;
+
+  case 35: /* expression: expression PLUS term  */
+#line 169 "misc/parser.y"
+                           { 
+        (yyval.expr) = new BinaryExpr((yyvsp[-2].expr), '+', (yyvsp[0].expr)); 
+    }
+#line 1440 "out/parser.cpp"
+    break;
+
+  case 36: /* expression: expression MINUS term  */
+#line 172 "misc/parser.y"
+                            { 
+        (yyval.expr) = new BinaryExpr((yyvsp[-2].expr), '-', (yyvsp[0].expr)); 
+    }
+#line 1448 "out/parser.cpp"
+    break;
+
+  case 37: /* term: factor  */
+#line 178 "misc/parser.y"
+           { 
+        (yyval.expr) = (yyvsp[0].expr); 
+    }
+#line 1456 "out/parser.cpp"
+    break;
+
+  case 38: /* term: MINUS factor  */
+#line 181 "misc/parser.y"
+                  { 
+        (yyval.expr) = new UnaryExpr('-', (yyvsp[0].expr)); 
+    }
+#line 1464 "out/parser.cpp"
+    break;
+
+  case 39: /* factor: literal  */
+#line 187 "misc/parser.y"
+            { 
+        (yyval.expr) = new NumberExpr((yyvsp[0].ival)); 
+    }
+#line 1472 "out/parser.cpp"
+    break;
+
+  case 40: /* factor: SYMBOL  */
+#line 190 "misc/parser.y"
+             { 
+        (yyval.expr) = new SymbolExpr((yyvsp[0].sval)); 
+        assembler.symbolUsageEquHandler((yyvsp[0].sval));
+        free((yyvsp[0].sval));
+    }
+#line 1482 "out/parser.cpp"
+    break;
+
+  case 41: /* factor: LPAREN expression RPAREN  */
+#line 195 "misc/parser.y"
+                               {
+         (yyval.expr) = (yyvsp[-1].expr); 
+    }
+#line 1490 "out/parser.cpp"
+    break;
+
+  case 42: /* symbol_list: SYMBOL  */
+#line 203 "misc/parser.y"
+           {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back((yyvsp[0].sval));
+        free((yyvsp[0].sval));
+    }
+#line 1500 "out/parser.cpp"
+    break;
+
+  case 43: /* symbol_list: symbol_list COMMA SYMBOL  */
+#line 208 "misc/parser.y"
+                               {
+        (yyvsp[-2].slist)->push_back((yyvsp[0].sval));
+        (yyval.slist) = (yyvsp[-2].slist);
+        free((yyvsp[0].sval));
+    }
+#line 1510 "out/parser.cpp"
+    break;
+
+  case 44: /* symbol_literal_list: symbol_or_literal  */
+#line 216 "misc/parser.y"
+                      {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back((*(yyvsp[0].slist))[0]);
+        (yyval.slist)->push_back((*(yyvsp[0].slist))[1]);
+        delete (yyvsp[0].slist);
+    }
+#line 1521 "out/parser.cpp"
+    break;
+
+  case 45: /* symbol_literal_list: symbol_literal_list COMMA symbol_or_literal  */
+#line 222 "misc/parser.y"
+                                                  {
+        (yyval.slist) = (yyvsp[-2].slist);
+        (yyval.slist)->push_back((*(yyvsp[0].slist))[0]);
+        (yyval.slist)->push_back((*(yyvsp[0].slist))[1]);
+        delete (yyvsp[0].slist);
+    }
+#line 1532 "out/parser.cpp"
+    break;
+
+  case 46: /* symbol_or_literal: SYMBOL  */
+#line 231 "misc/parser.y"
+           {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("sym");
+        (yyval.slist)->push_back((yyvsp[0].sval));
+    }
+#line 1542 "out/parser.cpp"
+    break;
+
+  case 47: /* symbol_or_literal: literal  */
+#line 236 "misc/parser.y"
+              {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("lit");
+        (yyval.slist)->push_back(std::to_string((yyvsp[0].ival)));
+    }
+#line 1552 "out/parser.cpp"
+    break;
+
+  case 48: /* literal: NUMBER  */
+#line 246 "misc/parser.y"
+           {
+        (yyval.ival) = (yyvsp[0].ival);
+    }
+#line 1560 "out/parser.cpp"
+    break;
+
+  case 49: /* literal: CHAR  */
+#line 249 "misc/parser.y"
+           {
+        (yyval.ival) = (yyvsp[0].ival);
+    }
+#line 1568 "out/parser.cpp"
+    break;
+
+  case 50: /* command: HALT  */
+#line 257 "misc/parser.y"
+         {
+        assembler.processInstruction("halt", {});
+    }
+#line 1576 "out/parser.cpp"
+    break;
+
+  case 51: /* command: INT  */
+#line 260 "misc/parser.y"
+          {
+        assembler.processInstruction("int", {});
+    }
+#line 1584 "out/parser.cpp"
+    break;
+
+  case 52: /* command: IRET  */
+#line 263 "misc/parser.y"
+           {
+        assembler.processInstruction("iret", {});
+    }
+#line 1592 "out/parser.cpp"
+    break;
+
+  case 53: /* command: WAIT  */
+#line 266 "misc/parser.y"
+           {
+        assembler.processInstruction("wait", {});
+    }
+#line 1600 "out/parser.cpp"
+    break;
+
+  case 54: /* command: CALL jmpOperand  */
+#line 269 "misc/parser.y"
+                      {
+        std::string mnemonic = "call" + (*(yyvsp[0].slist))[0];
+        (yyvsp[0].slist)->erase((yyvsp[0].slist)->begin());
+        assembler.processInstruction(mnemonic, *(yyvsp[0].slist));
+        delete (yyvsp[0].slist);
+    }
+#line 1611 "out/parser.cpp"
+    break;
+
+  case 55: /* command: RET  */
+#line 275 "misc/parser.y"
+          {
+        assembler.processInstruction("ret", {});
+    }
+#line 1619 "out/parser.cpp"
+    break;
+
+  case 56: /* command: JMP jmpOperand  */
+#line 278 "misc/parser.y"
+                     {
+        std::string mnemonic = "jmp" + (*(yyvsp[0].slist))[0];
+        (yyvsp[0].slist)->erase((yyvsp[0].slist)->begin());
+        assembler.processInstruction(mnemonic, *(yyvsp[0].slist));
+        delete (yyvsp[0].slist);
+    }
+#line 1630 "out/parser.cpp"
+    break;
+
+  case 57: /* command: BEQ GPR COMMA GPR COMMA jmpOperand  */
+#line 284 "misc/parser.y"
+                                         {
+        std::string mnemonic = "beq" + (*(yyvsp[0].slist))[0];
+        std::vector<std::string> operands;
+        operands.push_back(std::to_string((yyvsp[-4].ival)));
+        operands.push_back(std::to_string((yyvsp[-2].ival)));
+        operands.insert(operands.end(), (yyvsp[0].slist)->begin() + 1, (yyvsp[0].slist)->end());
+
+        assembler.processInstruction(mnemonic, operands);
+        delete (yyvsp[0].slist);
+    }
+#line 1645 "out/parser.cpp"
+    break;
+
+  case 58: /* command: BNE GPR COMMA GPR COMMA jmpOperand  */
+#line 294 "misc/parser.y"
+                                         {
+        std::string mnemonic = "bne" + (*(yyvsp[0].slist))[0];
+        std::vector<std::string> operands;
+        operands.push_back(std::to_string((yyvsp[-4].ival)));
+        operands.push_back(std::to_string((yyvsp[-2].ival)));
+        operands.insert(operands.end(), (yyvsp[0].slist)->begin() + 1, (yyvsp[0].slist)->end());
+
+        assembler.processInstruction(mnemonic, operands);
+        delete (yyvsp[0].slist);
+    }
+#line 1660 "out/parser.cpp"
+    break;
+
+  case 59: /* command: BGT GPR COMMA GPR COMMA jmpOperand  */
+#line 304 "misc/parser.y"
+                                         {
+        std::string mnemonic = "bgt" + (*(yyvsp[0].slist))[0];
+        std::vector<std::string> operands;
+        operands.push_back(std::to_string((yyvsp[-4].ival)));
+        operands.push_back(std::to_string((yyvsp[-2].ival)));
+        operands.insert(operands.end(), (yyvsp[0].slist)->begin() + 1, (yyvsp[0].slist)->end());
+
+        assembler.processInstruction(mnemonic, operands);
+        delete (yyvsp[0].slist);
+    }
+#line 1675 "out/parser.cpp"
+    break;
+
+  case 60: /* command: PUSH GPR  */
+#line 314 "misc/parser.y"
+               {
+        assembler.processInstruction("push", {std::to_string((yyvsp[0].ival))});
+    }
+#line 1683 "out/parser.cpp"
+    break;
+
+  case 61: /* command: POP GPR  */
+#line 317 "misc/parser.y"
+              {
+        assembler.processInstruction("pop", {std::to_string((yyvsp[0].ival))});
+    }
+#line 1691 "out/parser.cpp"
+    break;
+
+  case 62: /* command: XCHG GPR COMMA GPR  */
+#line 320 "misc/parser.y"
+                         {
+        assembler.processInstruction("xchg", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1699 "out/parser.cpp"
+    break;
+
+  case 63: /* command: ADD GPR COMMA GPR  */
+#line 323 "misc/parser.y"
+                        {
+        assembler.processInstruction("add", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1707 "out/parser.cpp"
+    break;
+
+  case 64: /* command: SUB GPR COMMA GPR  */
+#line 326 "misc/parser.y"
+                        {
+        assembler.processInstruction("sub", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1715 "out/parser.cpp"
+    break;
+
+  case 65: /* command: MUL GPR COMMA GPR  */
+#line 329 "misc/parser.y"
+                        {
+        assembler.processInstruction("mul", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1723 "out/parser.cpp"
+    break;
+
+  case 66: /* command: DIV GPR COMMA GPR  */
+#line 332 "misc/parser.y"
+                        {
+        assembler.processInstruction("div", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1731 "out/parser.cpp"
+    break;
+
+  case 67: /* command: NOT GPR  */
+#line 335 "misc/parser.y"
+              {
+        assembler.processInstruction("not", {std::to_string((yyvsp[0].ival)) });
+    }
+#line 1739 "out/parser.cpp"
+    break;
+
+  case 68: /* command: AND GPR COMMA GPR  */
+#line 338 "misc/parser.y"
+                        {
+        assembler.processInstruction("and", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1747 "out/parser.cpp"
+    break;
+
+  case 69: /* command: OR GPR COMMA GPR  */
+#line 341 "misc/parser.y"
+                       {
+        assembler.processInstruction("or", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1755 "out/parser.cpp"
+    break;
+
+  case 70: /* command: XOR GPR COMMA GPR  */
+#line 344 "misc/parser.y"
+                        {
+        assembler.processInstruction("xor", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1763 "out/parser.cpp"
+    break;
+
+  case 71: /* command: SHL GPR COMMA GPR  */
+#line 347 "misc/parser.y"
+                        {
+        assembler.processInstruction("shl", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1771 "out/parser.cpp"
+    break;
+
+  case 72: /* command: SHR GPR COMMA GPR  */
+#line 350 "misc/parser.y"
+                        {
+        assembler.processInstruction("shr", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1779 "out/parser.cpp"
+    break;
+
+  case 73: /* command: COPY GPR COMMA GPR COMMA GPR  */
+#line 353 "misc/parser.y"
+                                   {
+        assembler.processInstruction("copy", {std::to_string((yyvsp[-4].ival)), std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1787 "out/parser.cpp"
+    break;
+
+  case 74: /* command: FILL GPR COMMA GPR COMMA GPR  */
+#line 356 "misc/parser.y"
+                                   {
+        assembler.processInstruction("fill", {std::to_string((yyvsp[-4].ival)), std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1795 "out/parser.cpp"
+    break;
+
+  case 75: /* command: PADDB GPR COMMA GPR  */
+#line 359 "misc/parser.y"
+                          {
+        assembler.processInstruction("paddb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1803 "out/parser.cpp"
+    break;
+
+  case 76: /* command: PSUBB GPR COMMA GPR  */
+#line 362 "misc/parser.y"
+                          {
+        assembler.processInstruction("psubb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1811 "out/parser.cpp"
+    break;
+
+  case 77: /* command: PCMPEQB GPR COMMA GPR  */
+#line 365 "misc/parser.y"
+                            {
+        assembler.processInstruction("pcmpeqb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1819 "out/parser.cpp"
+    break;
+
+  case 78: /* command: PCMPGTB GPR COMMA GPR  */
+#line 368 "misc/parser.y"
+                            {
+        assembler.processInstruction("pcmpgtb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1827 "out/parser.cpp"
+    break;
+
+  case 79: /* command: PMINB GPR COMMA GPR  */
+#line 371 "misc/parser.y"
+                          {
+        assembler.processInstruction("pminb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1835 "out/parser.cpp"
+    break;
+
+  case 80: /* command: PMAXB GPR COMMA GPR  */
+#line 374 "misc/parser.y"
+                          {
+        assembler.processInstruction("pmaxb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1843 "out/parser.cpp"
+    break;
+
+  case 81: /* command: PADDH GPR COMMA GPR  */
+#line 377 "misc/parser.y"
+                          {
+        assembler.processInstruction("paddh", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1851 "out/parser.cpp"
+    break;
+
+  case 82: /* command: PSUBH GPR COMMA GPR  */
+#line 380 "misc/parser.y"
+                          {
+        assembler.processInstruction("psubh", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1859 "out/parser.cpp"
+    break;
+
+  case 83: /* command: PCMPEQH GPR COMMA GPR  */
+#line 383 "misc/parser.y"
+                            {
+        assembler.processInstruction("pcmpeqh", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1867 "out/parser.cpp"
+    break;
+
+  case 84: /* command: PCMPGTH GPR COMMA GPR  */
+#line 386 "misc/parser.y"
+                            {
+        assembler.processInstruction("pcmpgth", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1875 "out/parser.cpp"
+    break;
+
+  case 85: /* command: PMINH GPR COMMA GPR  */
+#line 389 "misc/parser.y"
+                          {
+        assembler.processInstruction("pminh", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1883 "out/parser.cpp"
+    break;
+
+  case 86: /* command: PMAXH GPR COMMA GPR  */
+#line 392 "misc/parser.y"
+                          {
+        assembler.processInstruction("pmaxh", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1891 "out/parser.cpp"
+    break;
+
+  case 87: /* command: PSHUFB GPR COMMA GPR  */
+#line 395 "misc/parser.y"
+                           {
+        assembler.processInstruction("pshufb", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival)) });
+    }
+#line 1899 "out/parser.cpp"
+    break;
+
+  case 88: /* command: LD loadOperand COMMA GPR  */
+#line 398 "misc/parser.y"
+                               {
+        std::string mnemonic = (*(yyvsp[-2].slist))[0];
+        (yyvsp[-2].slist)->erase((yyvsp[-2].slist)->begin());
+        (yyvsp[-2].slist)->push_back(std::to_string((yyvsp[0].ival)));
+
+        assembler.processInstruction(mnemonic, *(yyvsp[-2].slist));
+        delete (yyvsp[-2].slist);
+    }
+#line 1912 "out/parser.cpp"
+    break;
+
+  case 89: /* command: ST GPR COMMA storeOperand  */
+#line 406 "misc/parser.y"
+                                {
+        std::string mnemonic = (*(yyvsp[0].slist))[0];
+        (yyvsp[0].slist)->erase((yyvsp[0].slist)->begin());
+        (yyvsp[0].slist)->insert((yyvsp[0].slist)->begin(), std::to_string((yyvsp[-2].ival)));
+
+        assembler.processInstruction(mnemonic, *(yyvsp[0].slist));
+        delete (yyvsp[0].slist);
+    }
+#line 1925 "out/parser.cpp"
+    break;
+
+  case 90: /* command: CSRRD CSR COMMA GPR  */
+#line 414 "misc/parser.y"
+                          {
+        assembler.processInstruction("csrrd", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1933 "out/parser.cpp"
+    break;
+
+  case 91: /* command: CSRWR GPR COMMA CSR  */
+#line 417 "misc/parser.y"
+                          {
+        assembler.processInstruction("csrwr", {std::to_string((yyvsp[-2].ival)), std::to_string((yyvsp[0].ival))});
+    }
+#line 1941 "out/parser.cpp"
+    break;
+
+  case 92: /* jmpOperand: literal  */
+#line 425 "misc/parser.y"
+            {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("lit");
+        (yyval.slist)->push_back(std::to_string((yyvsp[0].ival)));
+    }
+#line 1951 "out/parser.cpp"
+    break;
+
+  case 93: /* jmpOperand: SYMBOL  */
+#line 430 "misc/parser.y"
+             {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("sym");
+        (yyval.slist)->push_back((yyvsp[0].sval));
+        free((yyvsp[0].sval));
+    }
+#line 1962 "out/parser.cpp"
+    break;
+
+  case 94: /* loadOperand: DOLLAR literal  */
+#line 439 "misc/parser.y"
+                   {
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldimm");
+        (yyval.slist)->push_back(std::to_string((yyvsp[0].ival)));
+    }
+#line 1972 "out/parser.cpp"
+    break;
+
+  case 95: /* loadOperand: DOLLAR SYMBOL  */
+#line 444 "misc/parser.y"
+                    { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldsym");
+        (yyval.slist)->push_back((yyvsp[0].sval));
+        free((yyvsp[0].sval));
+    }
+#line 1983 "out/parser.cpp"
+    break;
+
+  case 96: /* loadOperand: literal  */
+#line 450 "misc/parser.y"
+              { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldlit");
+        (yyval.slist)->push_back(std::to_string((yyvsp[0].ival)));
+    }
+#line 1993 "out/parser.cpp"
+    break;
+
+  case 97: /* loadOperand: SYMBOL  */
+#line 455 "misc/parser.y"
+             { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldsymabs");
+        (yyval.slist)->push_back((yyvsp[0].sval));
+        free((yyvsp[0].sval));
+    }
+#line 2004 "out/parser.cpp"
+    break;
+
+  case 98: /* loadOperand: GPR  */
+#line 461 "misc/parser.y"
+          { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldreg");
+        (yyval.slist)->push_back(std::to_string((yyvsp[0].ival)));
+    }
+#line 2014 "out/parser.cpp"
+    break;
+
+  case 99: /* loadOperand: LBRACKET GPR RBRACKET  */
+#line 466 "misc/parser.y"
+                            { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldind");
+        (yyval.slist)->push_back(std::to_string((yyvsp[-1].ival)));
+    }
+#line 2024 "out/parser.cpp"
+    break;
+
+  case 100: /* loadOperand: LBRACKET GPR PLUS literal RBRACKET  */
+#line 471 "misc/parser.y"
+                                         { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldindlit");
+        (yyval.slist)->push_back(std::to_string((yyvsp[-3].ival)));
+        (yyval.slist)->push_back(std::to_string((yyvsp[-1].ival))); 
+    }
+#line 2035 "out/parser.cpp"
+    break;
+
+  case 101: /* loadOperand: LBRACKET GPR PLUS SYMBOL RBRACKET  */
+#line 477 "misc/parser.y"
+                                        { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("ldindsym");
+        (yyval.slist)->push_back(std::to_string((yyvsp[-3].ival)));
+        (yyval.slist)->push_back((yyvsp[-1].sval));
+        free((yyvsp[-1].sval));
+    }
+#line 2047 "out/parser.cpp"
+    break;
+
+  case 102: /* storeOperand: literal  */
+#line 487 "misc/parser.y"
+            { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("stlit");
+        (yyval.slist)->push_back(std::to_string((yyvsp[0].ival)));
+    }
+#line 2057 "out/parser.cpp"
+    break;
+
+  case 103: /* storeOperand: SYMBOL  */
+#line 492 "misc/parser.y"
+             { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("stsymabs");
+        (yyval.slist)->push_back((yyvsp[0].sval));
+        free((yyvsp[0].sval));
+    }
+#line 2068 "out/parser.cpp"
+    break;
+
+  case 104: /* storeOperand: LBRACKET GPR RBRACKET  */
+#line 498 "misc/parser.y"
+                            { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("stind");
+        (yyval.slist)->push_back(std::to_string((yyvsp[-1].ival)));
+    }
+#line 2078 "out/parser.cpp"
+    break;
+
+  case 105: /* storeOperand: LBRACKET GPR PLUS literal RBRACKET  */
+#line 503 "misc/parser.y"
+                                         { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("stindlit");
+        (yyval.slist)->push_back(std::to_string((yyvsp[-3].ival)));
+        (yyval.slist)->push_back(std::to_string((yyvsp[-1].ival))); 
+    }
+#line 2089 "out/parser.cpp"
+    break;
+
+  case 106: /* storeOperand: LBRACKET GPR PLUS SYMBOL RBRACKET  */
+#line 509 "misc/parser.y"
+                                        { 
+        (yyval.slist) = new std::vector<std::string>();
+        (yyval.slist)->push_back("stindsym");
+        (yyval.slist)->push_back(std::to_string((yyvsp[-3].ival)));
+        (yyval.slist)->push_back((yyvsp[-1].sval));
+        free((yyvsp[-1].sval));
+    }
+#line 2101 "out/parser.cpp"
+    break;
+
+
+#line 2105 "out/parser.cpp"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 518 "misc/parser.y"
+
+
+void printUsage(const char* progName) {
+    std::cout << "Usage: " << progName << " <input_file> -o <output_file>\n";
+    std::cout << "\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h             Show this help message and exit.\n";
+    std::cout << "  -o <file>      Specify the output object file.\n";
+    std::cout << "\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " program.s -o program.o\n";
+    std::cout << "\n";
+}
+
+int main(int argc, char **argv) {
+    std::string inputFile;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+
+        } else if (arg == "-o") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: -o requires a filename\n";
+                return 1;
+            }
+            outputFile = argv[++i];
+        } else {
+            inputFile = arg;
+        }
+    }
+
+    if (inputFile.empty()) {
+        std::cerr << "Error: No input file specified\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (outputFile.empty()) {
+        std::cerr << "Error: -o option is required\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    
+    yyin = fopen(inputFile.c_str(), "r");
+    if (!yyin) {
+        std::cerr << "Error: Cannot open input file " << inputFile << "\n";
+        return 1;
+    }
+
+    
+    if (yyparse()) {
+        return 1;
+    }
+
+    
+    assembler.writeOutput(outputFile);
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_OUT_PARSER_HPP_INCLUDED
+# define YY_YY_OUT_PARSER_HPP_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 25 "misc/parser.y"
+
+    #include <vector>
+    #include <string>
+    #include "expression.hpp"
+
+#line 55 "out/parser.hpp"
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    GPR = 258,                     /* GPR  */
+    CSR = 259,                     /* CSR  */
+    NUMBER = 260,                  /* NUMBER  */
+    CHAR = 261,                    /* CHAR  */
+    SYMBOL = 262,                  /* SYMBOL  */
+    STRING = 263,                  /* STRING  */
+    GLOBAL = 264,                  /* GLOBAL  */
+    EXTERN = 265,                  /* EXTERN  */
+    SECTION = 266,                 /* SECTION  */
+    WORD = 267,                    /* WORD  */
+    SKIP = 268,                    /* SKIP  */
+    END = 269,                     /* END  */
+    ASCII = 270,                   /* ASCII  */
+    EQU = 271,                     /* EQU  */
+    HALT = 272,                    /* HALT  */
+    INT = 273,                     /* INT  */
+    IRET = 274,                    /* IRET  */
+    WAIT = 275,                    /* WAIT  */
+    CALL = 276,                    /* CALL  */
+    RET = 277,                     /* RET  */
+    JMP = 278,                     /* JMP  */
+    BEQ = 279,                     /* BEQ  */
+    BNE = 280,                     /* BNE  */
+    BGT = 281,                     /* BGT  */
+    PUSH = 282,                    /* PUSH  */
+    POP = 283,                     /* POP  */
+    XCHG = 284,                    /* XCHG  */
+    ADD = 285,                     /* ADD  */
+    SUB = 286,                     /* SUB  */
+    MUL = 287,                     /* MUL  */
+    DIV = 288,                     /* DIV  */
+    NOT = 289,                     /* NOT  */
+    AND = 290,                     /* AND  */
+    OR = 291,                      /* OR  */
+    XOR = 292,                     /* XOR  */
+    SHL = 293,                     /* SHL  */
+    SHR = 294,                     /* SHR  */
+    COPY = 295,                    /* COPY  */
+    FILL = 296,                    /* FILL  */
+    PADDB = 297,                   /* PADDB  */
+    PSUBB = 298,                   /* PSUBB  */
+    PCMPEQB = 299,                 /* PCMPEQB  */
+    PCMPGTB = 300,                 /* PCMPGTB  */
+    PMINB = 301,                   /* PMINB  */
+    PMAXB = 302,                   /* PMAXB  */
+    PADDH = 303,                   /* PADDH  */
+    PSUBH = 304,                   /* PSUBH  */
+    PCMPEQH = 305,                 /* PCMPEQH  */
+    PCMPGTH = 306,                 /* PCMPGTH  */
+    PMINH = 307,                   /* PMINH  */
+    PMAXH = 308,                   /* PMAXH  */
+    PSHUFB = 309,                  /* PSHUFB  */
+    LD = 310,                      /* LD  */
+    ST = 311,                      /* ST  */
+    CSRRD = 312,                   /* CSRRD  */
+    CSRWR = 313,                   /* CSRWR  */
+    DOLLAR = 314,                  /* DOLLAR  */
+    COLON = 315,                   /* COLON  */
+    COMMA = 316,                   /* COMMA  */
+    LBRACKET = 317,                /* LBRACKET  */
+    RBRACKET = 318,                /* RBRACKET  */
+    PLUS = 319,                    /* PLUS  */
+    MINUS = 320,                   /* MINUS  */
+    LPAREN = 321,                  /* LPAREN  */
+    RPAREN = 322,                  /* RPAREN  */
+    NEWLINE = 323                  /* NEWLINE  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 30 "misc/parser.y"
+
+    int ival;
+    char *sval;
+    std::vector<std::string> *slist;
+    Expression* expr; 
+
+#line 147 "out/parser.hpp"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_OUT_PARSER_HPP_INCLUDED  */
@@ -0,0 +1,63 @@
+#include "aotRuntime.hpp"
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+AotRuntime::AotRuntime(Emulator& emulator)
+    : gpr(reinterpret_cast<uint32_t*>(emulator.gpr)), csr(emulator.csr), emulator(emulator){
+}
+
+int AotRuntime::run(int argc, char** argv, const Image& image){
+    Emulator emulator;
+    bool headless = false;
+    std::string inputFile;
+    std::string outputFile;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("-ips=", 0) == 0) {
+            try {
+                emulator.setVirtualTime(std::stoull(arg.substr(5), nullptr, 0));
+            } catch (const std::logic_error&) {
+                std::cerr << "Invalid option value: " << arg << "\n";
+                return 1;
+            }
+        } else if (arg == "-headless") {
+            headless = true;
+        } else if (arg.rfind("-input=", 0) == 0) {
+            inputFile = arg.substr(7);
+        } else if (arg.rfind("-output=", 0) == 0) {
+            outputFile = arg.substr(8);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [options]\n\n";
+            std::cout << "Options (as for the emulator):\n";
+            std::cout << "  -h           Show this help message and exit\n";
+            std::cout << "  -ips=RATE    Virtual time at RATE instructions per second\n";
+            std::cout << "  -headless    Don't use the terminal\n";
+            std::cout << "  -input=FILE  Terminal input for -headless (- for standard input)\n";
+            std::cout << "  -output=FILE Terminal output for -headless\n\n";
+            return arg == "-h" ? 0 : 1;
+        }
+    }
+    if (headless) {
+        try {
+            emulator.setHeadless(inputFile, outputFile);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < image.segmentCount; ++i) {
+        const Segment& segment = image.segments[i];
+        emulator.loadMemory(segment.address, segment.bytes, segment.size);
+    }
+    AotRuntime runtime(emulator);
+    emulator.setNativeCode(&runtime, image.dispatcher, image.codePages, image.codePageCount);
+
+    try {
+        return emulator.emulate() ? 0 : 2;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Emulation error: " << e.what() << "\n";
+        return 2;
+    }
+}
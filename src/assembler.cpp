@@ -4,6 +4,7 @@
 #include <fstream>
 #include <cstring>
 #include "instructionEncoder.hpp"
+#include "packedLanes.hpp"
 #include "shelf.hpp"
 #include "section.hpp"
 #include "forwardRef.hpp"
@@ -156,6 +157,19 @@ void Assembler::symbolUsageHandler(const std::string& name, int offset, Relocati
         sym->forwardRefs.push_back(ref);
     }
 }
+//Modifier of the packed arithmetic opcode for each of its mnemonics
+static const std::map<std::string, uint8_t>& packedOperations(){
+    static const std::map<std::string, uint8_t> operations = {
+        {"paddb", PackedLanes::ADD_BYTES}, {"psubb", PackedLanes::SUB_BYTES},
+        {"pcmpeqb", PackedLanes::EQUAL_BYTES}, {"pcmpgtb", PackedLanes::GREATER_BYTES},
+        {"pminb", PackedLanes::MIN_BYTES}, {"pmaxb", PackedLanes::MAX_BYTES},
+        {"paddh", PackedLanes::ADD_HALVES}, {"psubh", PackedLanes::SUB_HALVES},
+        {"pcmpeqh", PackedLanes::EQUAL_HALVES}, {"pcmpgth", PackedLanes::GREATER_HALVES},
+        {"pminh", PackedLanes::MIN_HALVES}, {"pmaxh", PackedLanes::MAX_HALVES},
+        {"pshufb", PackedLanes::SHUFFLE_BYTES},
+    };
+    return operations;
+}
 void Assembler::processInstruction(const std::string &mnemonic,const std::vector<std::string> &operands){
     // std::cout << mnemonic;
     // for (const auto &op : operands) {
@@ -175,6 +189,9 @@ void Assembler::processInstruction(const std::string &mnemonic,const std::vector
         else if (mnemonic == "iret") {
             currentSection->emitBytes(InstructionEncoder::iret());
         }
+        else if (mnemonic == "wait") {
+            currentSection->emitBytes(InstructionEncoder::wait());
+        }
         else if (mnemonic == "ret") {
             currentSection->emitBytes(InstructionEncoder::ret());
         }
@@ -248,6 +265,19 @@ void Assembler::processInstruction(const std::string &mnemonic,const std::vector
             else if (mnemonic == "shl") currentSection->emitBytes(InstructionEncoder::shl(gprS, gprD));
             else if (mnemonic == "shr") currentSection->emitBytes(InstructionEncoder::shr(gprS, gprD));
         }
+        else if (packedOperations().count(mnemonic)) {
+            int gprS = std::stoi(operands[0]);
+            int gprD = std::stoi(operands[1]);
+            currentSection->emitBytes(InstructionEncoder::packed(packedOperations().at(mnemonic), gprS, gprD));
+        }
+        else if (mnemonic == "copy" || mnemonic == "fill") {
+            int gprS = std::stoi(operands[0]);
+            int gprD = std::stoi(operands[1]);
+            int gprN = std::stoi(operands[2]);
+
+            if (mnemonic == "copy") currentSection->emitBytes(InstructionEncoder::copy(gprS, gprD, gprN));
+            else currentSection->emitBytes(InstructionEncoder::fill(gprS, gprD, gprN));
+        }
         else if (mnemonic == "ldimm") {
             int literal = std::stoi(operands[0]);
             int gpr = std::stoi(operands[1]);
@@ -0,0 +1,273 @@
+#include "batchRunner.hpp"
+#include "emulator.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <chrono>
+
+namespace{
+    //Jobs of one worker; it takes them from the back, idle workers steal them from the front
+    struct WorkQueue{
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+
+        bool pop(size_t& job){
+            std::lock_guard<std::mutex> lock(mutex);
+            if(jobs.empty()) return false;
+            job = jobs.back();
+            jobs.pop_back();
+            return true;
+        }
+        bool steal(size_t& job){
+            std::lock_guard<std::mutex> lock(mutex);
+            if(jobs.empty()) return false;
+            job = jobs.front();
+            jobs.pop_front();
+            return true;
+        }
+    };
+
+    const char* statusName(BatchRunner::Result::Status status){
+        switch(status){
+            case BatchRunner::Result::HALTED: return "halted";
+            case BatchRunner::Result::FAILED: return "failed";
+            case BatchRunner::Result::OUT_OF_INSTRUCTIONS: return "out of instructions";
+            case BatchRunner::Result::OUT_OF_TIME: return "out of time";
+            case BatchRunner::Result::NOT_LOADED: return "not loaded";
+            default: return "not run";
+        }
+    }
+    double mips(uint64_t instructions, double seconds){
+        return seconds > 0 ? instructions / seconds / 1e6 : 0;
+    }
+}
+
+void BatchRunner::readManifest(const std::string& filename){
+    std::ifstream in(filename);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        Job job = defaults;
+        std::vector<std::string> inputs;
+        std::istringstream words(line);
+        std::string word;
+        try {
+            while (words >> word) {
+                if (word.rfind("-ips=", 0) == 0) {
+                    job.instructionsPerSecond = std::stoull(word.substr(5), nullptr, 0);
+                } else if (word.rfind("-max-instructions=", 0) == 0) {
+                    job.maxInstructions = std::stoull(word.substr(18), nullptr, 0);
+                } else if (word.rfind("-timeout=", 0) == 0) {
+                    job.timeout = std::stoull(word.substr(9), nullptr, 0);
+                } else if (word[0] == '-') {
+                    throw std::invalid_argument(word);
+                } else if (job.image.empty()) {
+                    job.image = word;
+                } else {
+                    inputs.push_back(word);
+                }
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Read error: bad option " + word + " at line " + std::to_string(lineNumber) + " of " + filename);
+        }
+        if (job.image.empty()) continue;
+
+        //One job per input script, or a single one without input
+        if (inputs.empty()) inputs.emplace_back();
+        for (const std::string& input : inputs) {
+            job.input = input;
+            jobs.push_back(job);
+        }
+    }
+}
+
+void BatchRunner::run(unsigned threads){
+    //Threads beyond one per job would have nothing to do
+    threadCount = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, jobs.size())));
+    results.assign(jobs.size(), Result());
+
+    std::vector<WorkQueue> queues(threadCount);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        queues[i % threadCount].jobs.push_back(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < threadCount; ++w) {
+        workers.emplace_back([&, w]() {
+            size_t job;
+            while (true) {
+                bool found = queues[w].pop(job);
+                //No job is ever added, so once every queue is empty the worker is done
+                for (unsigned other = 1; !found && other < threadCount; ++other) {
+                    found = queues[(w + other) % threadCount].steal(job);
+                }
+                if (!found) return;
+                runJob(jobs[job], results[job]);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BatchRunner::runJob(const Job& job, Result& result){
+    //Large, and only the worker's for the duration of the job
+    auto emulator = std::make_unique<Emulator>();
+    std::ostringstream output;
+    std::ostringstream state;
+    emulator->setVirtualTime(job.instructionsPerSecond);
+    emulator->setBudget(job.maxInstructions, job.timeout);
+    emulator->setStateOutput(state);
+    try {
+        emulator->readFile(job.image);
+        emulator->setHeadless(job.input, "");
+        emulator->setHeadlessOutput(output);
+    } catch (const std::runtime_error& e) {
+        result.status = Result::NOT_LOADED;
+        result.error = e.what();
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        if (!emulator->emulate()) {
+            result.status = Result::FAILED;
+        } else if (emulator->budgetExhausted() == Emulator::BUDGET_INSTRUCTIONS) {
+            result.status = Result::OUT_OF_INSTRUCTIONS;
+        } else if (emulator->budgetExhausted() == Emulator::BUDGET_TIME) {
+            result.status = Result::OUT_OF_TIME;
+        } else {
+            result.status = Result::HALTED;
+        }
+    } catch (const std::runtime_error& e) {
+        result.status = Result::FAILED;
+        result.error = e.what();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.instructions = emulator->retired();
+    result.output = output.str();
+    result.state = state.str();
+}
+
+void BatchRunner::printResults(std::ostream& out) const{
+    size_t counts[Result::NOT_LOADED + 1] = {};
+    uint64_t instructions = 0;
+    out << std::fixed;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const Job& job = jobs[i];
+        const Result& result = results[i];
+        counts[result.status]++;
+        instructions += result.instructions;
+
+        out << "== job " << i << ": " << job.image;
+        if (!job.input.empty()) out << " < " << job.input;
+        out << "\n" << statusName(result.status);
+        if (!result.error.empty()) out << ": " << result.error;
+        out << ", " << result.instructions << " instructions in " << std::setprecision(3) << result.seconds
+            << " s (" << std::setprecision(1) << mips(result.instructions, result.seconds) << " MIPS)\n";
+        if (!result.output.empty()) {
+            out << "-- terminal output\n" << result.output;
+            if (result.output.back() != '\n') out << "\n";
+        }
+        if (!result.state.empty()) {
+            out << "-- state" << result.state;
+        }
+        out << "\n";
+    }
+
+    out << "== " << jobs.size() << " jobs: " << counts[Result::HALTED] << " halted, "
+        << counts[Result::FAILED] << " failed, "
+        << counts[Result::OUT_OF_INSTRUCTIONS] + counts[Result::OUT_OF_TIME] << " out of budget, "
+        << counts[Result::NOT_LOADED] << " not loaded\n";
+    out << instructions << " instructions in " << std::setprecision(3) << wallSeconds << " s on "
+        << threadCount << " threads (" << std::setprecision(1) << mips(instructions, wallSeconds) << " MIPS)\n";
+    out << std::defaultfloat;
+}
+
+bool BatchRunner::allHalted() const{
+    for (const Result& result : results) {
+        if (result.status != Result::HALTED) return false;
+    }
+    return true;
+}
+
+void printUsage(const char* progName) {
+    std::cout << "Usage: " << progName << " [options] <manifest>\n\n";
+    std::cout << "Runs every job of the manifest headless, in parallel, and prints their results.\n";
+    std::cout << "Every manifest line holds an executable, any number of terminal input files (one job each,\n";
+    std::cout << "or a single job without input if there are none) and options for those jobs; # starts a comment.\n\n";
+    std::cout << "Options (also accepted on manifest lines, except -j):\n";
+    std::cout << "  -h           Show this help message and exit\n";
+    std::cout << "  -j=N         Number of threads (the host's cores by default)\n";
+    std::cout << "  -ips=RATE    Virtual time rate (100000000 by default); 0 runs the timer on the host's clock\n";
+    std::cout << "  -max-instructions=N  Stop a job once N instructions retired\n";
+    std::cout << "  -timeout=MS  Stop a job once MS milliseconds passed\n\n";
+    std::cout << "Exit status:\n";
+    std::cout << "  0 if every job halted, 1 if the manifest couldn't be read, 2 otherwise\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " -j=8 -max-instructions=100000000 jobs.txt\n\n";
+}
+int main(int argc, char** argv){
+    std::string manifest;
+    unsigned threads = std::thread::hardware_concurrency();
+    //Virtual time needs no device thread and makes every run the same
+    BatchRunner::Job defaults{"", "", 100000000, 0, 0};
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg.rfind("-j=", 0) == 0) {
+                threads = std::stoul(arg.substr(3), nullptr, 0);
+            } else if (arg.rfind("-ips=", 0) == 0) {
+                defaults.instructionsPerSecond = std::stoull(arg.substr(5), nullptr, 0);
+            } else if (arg.rfind("-max-instructions=", 0) == 0) {
+                defaults.maxInstructions = std::stoull(arg.substr(18), nullptr, 0);
+            } else if (arg.rfind("-timeout=", 0) == 0) {
+                defaults.timeout = std::stoull(arg.substr(9), nullptr, 0);
+            } else if (manifest.empty()) {
+                manifest = arg;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {
+        std::cerr << "Invalid option value\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (manifest.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    BatchRunner runner(defaults);
+    try {
+        runner.readManifest(manifest);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    runner.run(threads);
+    runner.printResults(std::cout);
+    return runner.allHalted() ? 0 : 2;
+}
@@ -1,11 +1,23 @@
 #include "emulator.hpp"
+#include "imageReader.hpp"
+#include "snapshot.hpp"
+#include "traceRing.hpp"
+#include "packedLanes.hpp"
+#include "jitCompiler.hpp"
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 #include <thread>
 #include <termios.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <algorithm>
+#include <iterator>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
 Emulator::Emulator(){
     for(auto& r: gpr){
@@ -14,85 +26,817 @@ Emulator::Emulator(){
     for(auto& r: csr){
         r = 0;
     }
+    gpr[PC] = START_ADDRESS;
+    stateOutput = &std::cout;
+}
+Emulator::~Emulator() = default;
+Emulator::Emulator(const Emulator& parent) : memory(std::make_shared<PagedMemory>(*parent.memory)){
+    std::copy(std::begin(parent.gpr), std::end(parent.gpr), gpr);
+    std::copy(std::begin(parent.csr), std::end(parent.csr), csr);
+    stateOutput = &std::cout;
+    pendingInterrupts = parent.pendingInterrupts.load();
+    term_in = parent.term_in.load();
+    dmaAddress = parent.dmaAddress;
+    dmaLength = parent.dmaLength;
+    handlerInstalled = parent.handlerInstalled;
+    tim_cfg = parent.tim_cfg.load();
+    timerStart = parent.timerStart.load();
+    blockTranslation = parent.blockTranslation;
+    jitEnabled = parent.jitEnabled;
+    perfMap = parent.perfMap;
+    instructionCount = parent.instructionCount;
+    virtualRate = parent.virtualRate;
+    timerDeadline = parent.timerDeadline;
+    updateDeadline();
+}
+Emulator::Emulator(Emulator& machine, unsigned id) : Emulator(){
+    memory = machine.memory;
+    this->machine = &machine;
+    coreId = id;
+    coreCount = machine.coreCount;
+    stateOutput = machine.stateOutput;
+    blockTranslation = machine.blockTranslation;
+    jitEnabled = machine.jitEnabled;
+    perfMap = machine.perfMap;
+    virtualRate = machine.virtualRate;
+    budgetInstructions = machine.budgetInstructions;
+    budgetMilliseconds = machine.budgetMilliseconds;
+}
+std::unique_ptr<Emulator> Emulator::fork() const{
+    return std::unique_ptr<Emulator>(new Emulator(*this));
+}
+void Emulator::setStateOutput(std::ostream& out){
+    stateOutput = &out;
 }
 void Emulator::printRegisters(){
+    if(!otherCores.empty()) *stateOutput << "Core 0:\n";
     for (int i = 0; i < 16; i++) {
-        std::cout << std::right << std::setw(3) << ("r" + std::to_string(i))
+        *stateOutput << std::right << std::setw(3) << ("r" + std::to_string(i))
                   << "=0x"
                   << std::hex << std::setw(8) << std::setfill('0') << gpr[i]
                   << std::dec << std::setfill(' ') << "  ";
 
         //4 registers per line
         if (i % 4 == 3)
-            std::cout << '\n';
+            *stateOutput << '\n';
+    }
+    *stateOutput << std::endl;
+    for(auto& other: otherCores){
+        *stateOutput << "Core " << other->coreId << ":\n";
+        other->printRegisters();
     }
-    std::cout << std::endl;
 }
 void Emulator::readFile(const std::string& filename){
-    std::ifstream in(filename, std::ios::binary);
-    if (!in) {
-        throw std::runtime_error("Cannot open file: " + filename);
+    ImageReader reader(filename);
+    for(const auto& segment: reader.getSegments()){
+        loadMemory(segment.address, segment.bytes, segment.size);
     }
-    while (true) {
-        uint32_t address;
-        uint8_t value;
-
-        // Read 4B address
-        in.read(reinterpret_cast<char*>(&address), sizeof(address));
-        if (in.eof()) break;
-
-        // Read 1B value
-        in.read(reinterpret_cast<char*>(&value), sizeof(value));
-        if (in.eof()) break;
-
-        auto it = memory.find(address);
-        if (it == memory.end()){
-            memory[address] = value;
-        }else{
-            std::ostringstream oss;
-            oss << "Input error: multiple values for address 0x"
-                << std::hex << std::setw(8) << std::setfill('0') << address;
-            throw std::runtime_error(oss.str());
-        }
-        
+}
+void Emulator::loadMemory(uint32_t address, const uint8_t* data, size_t length){
+    memory->writeBytes(address, data, length);
+    //Anything decoded from the overwritten range is stale
+    for(size_t offset = 0; offset < length; offset += PagedMemory::PAGE_SIZE){
+        decodeCache.invalidate(address + offset);
     }
+    if(length > 0) decodeCache.invalidate(address + length - 1);
 }
-void Emulator::emulate(){
+bool Emulator::emulate(){
     emulatorRunning = true;
-    gpr[PC] = START_ADDRESS;
-    std::thread timer_thread{&Emulator::timer, this};
-    std::thread terminal_thread{&Emulator::terminal, this};
+    devicesRunning = true;
+    forkPointReached = false;
+    clockStart = monotonicNanoseconds();
+    startBudget();
+    startCores();
+    doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(doorbell < 0){
+        throw std::runtime_error("Emulation error: can't create the device doorbell");
+    }
+    headlessInputWaiting = headless && headlessInputPosition < headlessInput.size();
+    //A restored program may have installed its handler already
+    if(handlerInstalled) csrWritten(HANDLER);
+    //As may it have started the timer
+    if(timerStart && !virtualRate) ringDoorbell();
+    //A headless run in virtual time has nothing for the device thread to do
+    std::thread device_thread;
+    if(!headless || !virtualRate) device_thread = std::thread{&Emulator::devices, this};
+    bool failed = false;
+    std::string error;
     try{
         //Main loop
-        while(emulatorRunning){
-            uint32_t instruction = instructionFetch();
-            instructionDecodeAndExecute(instruction);
-            handleInterrupts();
+        if(restoredHalted){
+            //Restored after the halt: there is nothing left to run
+        }else if(!otherCores.empty()) runCores();
+        else if(profiler && trace) run<true, true>();
+        else if(profiler) run<true, false>();
+        else if(trace) run<false, true>();
+        else run<false, false>();
+        if(snapshotTrigger == SNAPSHOT_AT_HALT && !forkPointReached && !budgetStop && snapshotArmed()) snapshotReached(true);
+    }catch(std::runtime_error& ex){
+        failed = true;
+        error = ex.what();
+    }
+    //The trace ends with the instruction that failed, if one did
+    if(trace){
+        try{
+            trace->write(traceFile);
+        }catch(std::runtime_error& ex){
+            std::cerr << ex.what() << "\n";
         }
+    }
+    //Stop the device thread (it is still running after a fatal error) and join with it;
+    //it prints whatever terminal output is still queued before it stops
+    emulatorRunning = false;
+    devicesRunning = false;
+    ringDoorbell();
+    if (device_thread.joinable()) device_thread.join();
+    close(doorbell);
+    doorbell = -1;
+    if(headless) headlessOutput->flush();
+    if(profiler) writeProfile();
+
+    std::ostream& out = *stateOutput;
+    if(failed){
+        //Fatal error curred during execution - print out register states
+        out << "\n-----------------------------------------------------------------\n";
+        out << "Emulated processor encountered a fatal error:" << error << "\n";
+        out << "Emulated processor state:\n";
+        printRegisters();
+    }else if(forkPointReached){
+        out << "\n-----------------------------------------------------------------\n";
+        out << "Emulated processor stopped at the fork point\n";
+        out << "Emulated processor state:\n";
+        printRegisters();
+    }else if(budgetStop){
+        out << "\n-----------------------------------------------------------------\n";
+        out << "Emulated processor stopped: " << (budgetStop == BUDGET_INSTRUCTIONS ? "instruction" : "time") << " budget exhausted\n";
+        out << "Emulated processor state:\n";
+        printRegisters();
+    }else{
         //Regularly exited - print out register states
-        std::cout << "\n-----------------------------------------------------------------\n";
-        std::cout << "Emulated processor executed halt instruction\n";
-        std::cout << "Emulated processor state:\n";
+        out << "\n-----------------------------------------------------------------\n";
+        out << (restoredHalted ? "Emulated processor was halted when the snapshot was taken\n"
+                               : "Emulated processor executed halt instruction\n");
+        out << "Emulated processor state:\n";
         printRegisters();
+    }
+    return !failed;
+}
+
+void Emulator::setCores(unsigned count, bool roundRobinCores, uint64_t quantum){
+    coreCount = std::max(count, 1u);
+    roundRobin = roundRobinCores;
+    roundRobinQuantum = std::max<uint64_t>(quantum, 1);
+    otherCores.clear();
+}
+void Emulator::startCores(){
+    if(otherCores.empty()){
+        for(unsigned id = 1; id < coreCount; id++) otherCores.push_back(std::unique_ptr<Emulator>(new Emulator(*this, id)));
+    }
+    sharedCode = roundRobin && !otherCores.empty();
+    for(auto& other: otherCores){
+        other->emulatorRunning = true;
+        other->clockStart = clockStart;
+        other->startBudget();
+        other->sharedCode = sharedCode;
+    }
+}
+void Emulator::runCores(){
+    if(roundRobin) runRoundRobin();
+    else runParallel();
+    //The machine stopped at the first budget any of its cores ran out of
+    for(auto& other: otherCores){
+        if(!budgetStop) budgetStop = other->budgetStop;
+    }
+}
+void Emulator::runParallel(){
+    memory->share();
+    //Every core checks the code it runs against the same generations, which any of them moves on by writing
+    if(!codeGenerations) codeGenerations.reset(new uint32_t[1u << (32 - PagedMemory::PAGE_BITS)]());
+    for(unsigned id = 0; id < coreCount; id++) core(id).decodeCache.share(codeGenerations.get());
+    parallelCores = true;
+    std::vector<std::thread> threads;
+    for(auto& other: otherCores){
+        threads.emplace_back([this, &other](){
+            try{
+                other->run<false, false>();
+            }catch(std::runtime_error& ex){
+                other->coreError = ex.what();
+                stopCores();
+            }
+            if(other->budgetStop) stopCores();
+        });
+    }
+    //Core 0 runs on this thread
+    try{
+        run<false, false>();
     }catch(std::runtime_error& ex){
-        //Fatal error curred during execution - print out register states
-        std::cout << "\n-----------------------------------------------------------------\n";
-        std::cout << "Emulated processor encountered a fatal error:" << ex.what() << "\n";
-        std::cout << "Emulated processor state:\n";
-        printRegisters();
+        coreError = ex.what();
+        stopCores();
+    }
+    if(budgetStop) stopCores();
+    for(auto& thread: threads) thread.join();
+    parallelCores = false;
+    for(unsigned id = 0; id < coreCount; id++){
+        if(!core(id).coreError.empty()){
+            throw std::runtime_error("Core " + std::to_string(id) + ": " + core(id).coreError);
+        }
+    }
+}
+void Emulator::runRoundRobin(){
+    std::vector<bool> halted(coreCount, false);
+    bool running = true;
+    while(running){
+        running = false;
+        bool allIdle = true;
+        for(unsigned id = 0; id < coreCount; id++){
+            if(halted[id]) continue;
+            Emulator& turn = core(id);
+            turn.emulatorRunning = true;
+            turn.quantumExpired = false;
+            turn.idleTurn = false;
+            turn.quantumDeadline = turn.instructionCount + roundRobinQuantum;
+            turn.updateDeadline();
+            try{
+                turn.run<false, false>();
+            }catch(std::runtime_error& ex){
+                throw std::runtime_error("Core " + std::to_string(id) + ": " + ex.what());
+            }
+            if(turn.budgetStop){
+                budgetStop = turn.budgetStop;
+                return;
+            }
+            halted[id] = !turn.quantumExpired;
+            running = running || !halted[id];
+            allIdle = allIdle && (halted[id] || turn.idleTurn);
+        }
+        if(running && allIdle){
+            //Only the devices can wake the cores up now, through an interrupt for core 0
+            emulatorRunning = true;
+            bool inTime = sleep(!halted[0]);
+            emulatorRunning = false;
+            if(!inTime){
+                budgetStop = BUDGET_TIME;
+                return;
+            }
+        }
+    }
+}
+void Emulator::stopCores(){
+    emulatorRunning = false;
+    wake();
+    for(auto& other: otherCores){
+        other->emulatorRunning = false;
+        other->wake();
+    }
+}
+void Emulator::interruptCores(uint32_t mask){
+    for(unsigned id = 0; id < coreCount && id < 32; id++){
+        if(mask & (1u << id)) core(id).raiseInterrupt(IPI_INTERRUPT);
+    }
+}
+void Emulator::invalidateCores(uint32_t address, const Emulator* writer){
+    for(unsigned id = 0; id < coreCount; id++){
+        if(&core(id) == writer) continue;
+        core(id).decodeCache.invalidate(address);
+        core(id).decodeCache.invalidate(address + 3);
+    }
+}
+void Emulator::setBlockTranslation(bool enabled){
+    blockTranslation = enabled;
+}
+void Emulator::setJit(bool enabled){
+    jitEnabled = enabled;
+}
+void Emulator::setPerfMap(bool enabled){
+    perfMap = enabled;
+}
+void Emulator::setVirtualTime(uint64_t instructionsPerSecond){
+    virtualRate = instructionsPerSecond;
+}
+void Emulator::setBudget(uint64_t instructions, uint64_t milliseconds){
+    budgetInstructions = instructions;
+    budgetMilliseconds = milliseconds;
+}
+Emulator::BudgetStop Emulator::budgetExhausted() const{
+    return budgetStop;
+}
+uint64_t Emulator::retired() const{
+    return instructionCount;
+}
+void Emulator::startBudget(){
+    budgetStop = BUDGET_LEFT;
+    budgetEnd = budgetInstructions ? instructionCount + budgetInstructions : UINT64_MAX;
+    budgetTimeEnd = budgetMilliseconds ? clockStart + budgetMilliseconds * 1000000 : UINT64_MAX;
+    budgetDeadline = std::min(budgetEnd, budgetMilliseconds ? instructionCount + BUDGET_CLOCK_INTERVAL : UINT64_MAX);
+    updateDeadline();
+}
+void Emulator::budgetReached(){
+    if(instructionCount >= budgetEnd){
+        budgetStop = BUDGET_INSTRUCTIONS;
+    }else if(budgetTimeEnd != UINT64_MAX && monotonicNanoseconds() >= budgetTimeEnd){
+        budgetStop = BUDGET_TIME;
+    }else{
+        budgetDeadline = std::min(budgetEnd, instructionCount + BUDGET_CLOCK_INTERVAL);
+        return;
+    }
+    budgetDeadline = UINT64_MAX;
+    emulatorRunning = false;
+    blockExit = true;
+}
+void Emulator::setHeadlessOutput(std::ostream& out){
+    outputFile.reset();
+    headlessOutput = &out;
+}
+void Emulator::setHeadless(const std::string& inputFile, const std::string& outputFilename){
+    headless = true;
+    headlessInput.clear();
+    headlessInputPosition = 0;
+    if(inputFile == "-"){
+        headlessInput.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }else if(!inputFile.empty()){
+        std::ifstream in(inputFile, std::ios::binary);
+        if(!in){
+            throw std::runtime_error("Cannot open file: " + inputFile);
+        }
+        headlessInput.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    if(outputFilename.empty()){
+        outputFile.reset();
+        headlessOutput = &std::cout;
+    }else{
+        outputFile = std::make_unique<std::ofstream>(outputFilename, std::ios::binary);
+        if(!*outputFile){
+            throw std::runtime_error("Cannot open file: " + outputFilename);
+        }
+        headlessOutput = outputFile.get();
+    }
+}
+void Emulator::setSnapshot(const std::string& filename, SnapshotTrigger trigger, uint64_t instruction){
+    snapshotFile = filename;
+    forkPoint = false;
+    snapshotTrigger = trigger;
+    snapshotDeadline = trigger == SNAPSHOT_AT_INSTRUCTION ? instruction : UINT64_MAX;
+    updateDeadline();
+}
+void Emulator::setForkPoint(SnapshotTrigger trigger, uint64_t instruction){
+    snapshotFile.clear();
+    forkPoint = true;
+    snapshotTrigger = trigger;
+    snapshotDeadline = trigger == SNAPSHOT_AT_INSTRUCTION ? instruction : UINT64_MAX;
+    updateDeadline();
+}
+void Emulator::snapshotReached(bool halted){
+    if(!forkPoint){
+        writeSnapshot(halted);
+        return;
+    }
+    //Stop right here; the fork point is passed only once
+    forkPoint = false;
+    forkPointReached = true;
+    emulatorRunning = false;
+    blockExit = true;
+}
+void Emulator::writeSnapshot(bool halted){
+    std::ofstream out(snapshotFile, std::ios::binary);
+    if(!out){
+        throw std::runtime_error("Cannot open file: " + snapshotFile);
+    }
+    SnapshotHeader header = {};
+    std::copy(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), header.magic);
+    header.instructionCount = instructionCount;
+    header.virtualRate = virtualRate;
+    header.timerDeadline = timerDeadline;
+    std::copy(gpr, gpr + 16, header.gpr);
+    std::copy(csr, csr + 3, header.csr);
+    header.tim_cfg = tim_cfg;
+    header.term_in = term_in;
+    header.dmaAddress = dmaAddress;
+    header.dmaLength = dmaLength;
+    header.pendingInterrupts = pendingInterrupts;
+    header.flags = (timerStart ? SNAPSHOT_TIMER_STARTED : 0) | (handlerInstalled ? SNAPSHOT_HANDLER_INSTALLED : 0)
+        | (halted ? SNAPSHOT_HALTED : 0);
+
+    //Pages holding only zeros read the same as pages that were never written
+    std::vector<std::pair<uint32_t, const uint8_t*>> pages;
+    memory->forEachPage([&pages](uint32_t address, const uint8_t* bytes){
+        if(std::any_of(bytes, bytes + PagedMemory::PAGE_SIZE, [](uint8_t b){ return b != 0; })){
+            pages.emplace_back(address, bytes);
+        }
+    });
+    header.pageCount = pages.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(const auto& page: pages){
+        out.write(reinterpret_cast<const char*>(&page.first), sizeof(page.first));
+        out.write(reinterpret_cast<const char*>(page.second), PagedMemory::PAGE_SIZE);
+    }
+    if(!out){
+        throw std::runtime_error("Write error: " + snapshotFile);
+    }
+    //A snapshot is taken only once
+    snapshotFile.clear();
+}
+void Emulator::restoreSnapshot(const std::string& filename){
+    std::ifstream in(filename, std::ios::binary);
+    if(!in){
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    SnapshotHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if(!in || !std::equal(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), header.magic)){
+        throw std::runtime_error("Read error: " + filename + " is not a snapshot");
+    }
+    std::vector<uint8_t> page(PagedMemory::PAGE_SIZE);
+    for(uint32_t i = 0; i < header.pageCount; i++){
+        uint32_t address;
+        in.read(reinterpret_cast<char*>(&address), sizeof(address));
+        in.read(reinterpret_cast<char*>(page.data()), page.size());
+        if(!in){
+            throw std::runtime_error("Read error: truncated snapshot " + filename);
+        }
+        loadMemory(address & ~PagedMemory::PAGE_MASK, page.data(), page.size());
+    }
 
+    std::copy(header.gpr, header.gpr + 16, gpr);
+    std::copy(header.csr, header.csr + 3, csr);
+    tim_cfg = header.tim_cfg;
+    term_in = header.term_in;
+    dmaAddress = header.dmaAddress;
+    dmaLength = header.dmaLength;
+    pendingInterrupts = header.pendingInterrupts;
+    handlerInstalled = header.flags & SNAPSHOT_HANDLER_INSTALLED;
+    timerStart = header.flags & SNAPSHOT_TIMER_STARTED;
+    restoredHalted = header.flags & SNAPSHOT_HALTED;
+    instructionCount = header.instructionCount;
+    //The virtual timer goes on where it was if the clock rate is the same, otherwise a new period starts
+    if(timerStart && virtualRate){
+        timerDeadline = header.virtualRate == virtualRate && header.timerDeadline != UINT64_MAX
+            ? header.timerDeadline : instructionCount + virtualTimerPeriod(tim_cfg);
+    }else{
+        timerDeadline = UINT64_MAX;
+    }
+    if(snapshotTrigger == SNAPSHOT_AT_INSTRUCTION && snapshotDeadline < instructionCount){
+        snapshotDeadline = instructionCount;
+    }
+    updateDeadline();
+}
+void Emulator::setProfile(const std::string& reportFile){
+    profileFile = reportFile;
+    if(!profiler) profiler = std::make_unique<Profiler>();
+}
+void Emulator::setSymbolMap(const std::string& mapFile){
+    symbolMap = std::make_unique<SymbolMap>(mapFile);
+}
+void Emulator::setCallGraph(const std::string& stacksFile){
+    callGraphFile = stacksFile;
+    if(!profiler) profiler = std::make_unique<Profiler>();
+    profiler->enableCallGraph();
+}
+void Emulator::writeProfile(){
+    if(!profileFile.empty()){
+        std::ofstream out(profileFile);
+        if(out) profiler->writeReport(out, symbolMap.get());
+        else std::cerr << "Cannot open file: " << profileFile << "\n";
+    }
+    if(!callGraphFile.empty()){
+        std::ofstream out(callGraphFile);
+        if(out) profiler->writeFoldedStacks(out, symbolMap.get());
+        else std::cerr << "Cannot open file: " << callGraphFile << "\n";
+    }
+}
+void Emulator::setTrace(const std::string& traceFilename, size_t entries){
+    traceFile = traceFilename;
+    trace = std::make_unique<TraceRing>(entries);
+}
+void Emulator::traceDecode(uint8_t oc, uint8_t mod, DecodedInstruction& decoded){
+    //Registers not used by the rule stay r0, which reads as 0
+    uint8_t first = 0;
+    uint8_t second = 0;
+    uint8_t value = 0;
+    uint8_t flags = 0;
+    switch(oc){
+        case 0x2: //Call
+            if(mod == 0){
+                first = SP;
+                flags = TRACE_PUSH;
+            }else if(mod == 1){
+                first = decoded.a;
+                second = decoded.b;
+                flags = TRACE_DISP;
+            }
+            value = PC;
+            break;
+        case 0x3: //Jumps, the ones through memory read the target
+            if(mod >= 8){
+                first = decoded.a;
+                flags = TRACE_DISP;
+            }
+            value = PC;
+            break;
+        case 0x4: //Xchg
+            value = decoded.b;
+            break;
+        case 0x8: //Store
+            first = decoded.a;
+            if(mod != 1) second = decoded.b;
+            flags = TRACE_DISP | (mod == 2 ? TRACE_INDIRECT : 0);
+            value = decoded.c;
+            break;
+        case 0x9: //Load
+            if(mod == 2 || mod == 6){
+                first = decoded.b;
+                second = decoded.c;
+                flags = TRACE_DISP;
+            }else if(mod == 3 || mod == 7){
+                first = decoded.b;
+            }
+            value = decoded.a;
+            if(mod >= 4) flags |= decoded.a < 3 ? TRACE_CSR : 0;
+            if(mod >= 4 && decoded.a >= 3) value = 0;
+            break;
+        case 0x5: //Arithmetic
+        case 0x6: //Logic
+        case 0x7: //Shift
+        case 0xC: //Packed arithmetic
+            value = decoded.a;
+            break;
+        case 0xB: //Block copy and fill, the destination and the length
+            first = decoded.a;
+            value = decoded.c;
+            break;
+    }
+    decoded.traceFirst = first;
+    decoded.traceSecond = second;
+    decoded.traceValue = value;
+    decoded.traceFlags = flags;
+}
+template<bool PROFILE, bool TRACE>
+void Emulator::run(){
+    if(blockTranslation){
+        runBlocks<PROFILE, TRACE>();
+    }else{
+        runInterpreter<PROFILE, TRACE>();
+    }
+}
+template<bool PROFILE, bool TRACE>
+void Emulator::executeInstruction(uint32_t pc, const DecodedInstruction& di){
+    TraceEntry* entry = nullptr;
+    if constexpr (TRACE){
+        //Recorded before it executes, so an instruction that fails is in the trace too
+        entry = &trace->record(pc, di.word, traceAddress(di));
+    }
+    uint64_t retired = instructionCount;
+    (this->*di.handler)(di);
+    //Not taken branches of fused sequences retire one more instruction
+    if constexpr (PROFILE) profiler->retire(pc, di.count + instructionCount - retired);
+    if constexpr (TRACE) entry->value = traceValue(di);
+}
+template<bool PROFILE, bool TRACE>
+void Emulator::runInterpreter(){
+    while(emulatorRunning){
+        uint32_t pc = gpr[PC];
+        const DecodedInstruction& instruction = instructionFetch();
+        if constexpr (PROFILE || TRACE){
+            executeInstruction<PROFILE, TRACE>(pc, instruction);
+        }else{
+            (this->*instruction.handler)(instruction);
+        }
+        instructionCount += instruction.count;
+        handleInterrupts();
+    }
+}
+template<bool PROFILE, bool TRACE>
+void Emulator::runBlocks(){
+    TranslatedBlock* previous = nullptr;
+    while(emulatorRunning){
+        uint32_t pc = gpr[PC];
+        TranslatedBlock* block;
+        //Native blocks can't be profiled or traced
+        NativeBlock native = !PROFILE && !TRACE && nativeCodeValid ? nativeDispatcher(pc) : nullptr;
+        if(native){
+            //Native blocks are never chained, the dispatcher is as fast as a lookup
+            blockExit = false;
+            native(*nativeRuntime);
+            block = nullptr;
+        }else{
+            block = previous ? previous->chained(pc) : nullptr;
+            if(!block){
+                block = findBlock(pc);
+                if(previous && block) previous->chain(pc, block);
+            }
+            //Neither can compiled blocks
+            bool compiled = false;
+            if constexpr (!PROFILE && !TRACE){
+                if(block && !block->native && jitEnabled && ++block->executions == JIT_THRESHOLD) compileBlock(*block);
+                compiled = block && block->native;
+            }
+            if(compiled){
+                executeCompiled(*block);
+            }else if(block){
+                executeBlock<PROFILE, TRACE>(*block);
+            }else{
+                //PC can't start a block, interpret a single instruction
+                blockExit = false;
+                const DecodedInstruction& instruction = instructionFetch();
+                if constexpr (PROFILE || TRACE){
+                    executeInstruction<PROFILE, TRACE>(pc, instruction);
+                }else{
+                    (this->*instruction.handler)(instruction);
+                }
+                instructionCount += instruction.count;
+            }
+        }
+        //Only stops that may come from a write into code need a look at the native pages
+        if(blockExit && nativeCodeValid) checkNativeCode();
+        previous = block;
+        //Interrupts are only taken between blocks
+        handleInterrupts();
+    }
+}
+void Emulator::setNativeCode(AotRuntime* runtime, NativeDispatcher dispatcher, const uint32_t* pages, size_t pageCount){
+    nativeRuntime = runtime;
+    nativeDispatcher = dispatcher;
+    nativePages.clear();
+    for(size_t i = 0; i < pageCount; i++){
+        const uint32_t* generation = decodeCache.generation(pages[i] << PagedMemory::PAGE_BITS);
+        nativePages.emplace_back(generation, *generation);
+    }
+    nativeCodeValid = dispatcher != nullptr;
+}
+void Emulator::checkNativeCode(){
+    for(const auto& page: nativePages){
+        if(*page.first != page.second){
+            //Self-modifying code: fall back to blocks translated from the current memory contents
+            nativeCodeValid = false;
+            return;
+        }
+    }
+}
+void Emulator::compileBlock(TranslatedBlock& block){
+    if(!jit){
+        if(!JitCompiler::supported()){
+            jitEnabled = false;
+            return;
+        }
+        jit = std::make_unique<JitCompiler>(*this);
+        jit->setPerfMap(perfMap);
+    }
+    block.native = jit->compile(block);
+}
+void Emulator::executeCompiled(const TranslatedBlock& block){
+    blockExit = false;
+    runningBlock = &block;
+    //Runs on into the blocks it jumps to, as long as they are compiled too
+    block.native(this);
+    runningBlock = nullptr;
+    jit->rethrow();
+}
+Emulator::TranslatedBlock* Emulator::TranslatedBlock::chained(uint32_t pc) const{
+    for(const auto& exit: exits){
+        if(exit.pc == pc && exit.block && exit.block->valid()) return exit.block;
+    }
+    return nullptr;
+}
+void Emulator::TranslatedBlock::chain(uint32_t pc, TranslatedBlock* block){
+    for(auto& exit: exits){
+        if(exit.pc == pc){
+            exit.block = block;
+            return;
+        }
     }
-    //Join with timer and terminal threads
-    if (timer_thread.joinable()) timer_thread.join();
-    if (terminal_thread.joinable()) terminal_thread.join();
+    //Replace the exits in turns
+    exits[nextExit] = {pc, block};
+    nextExit = (nextExit + 1) % 2;
 }
+Emulator::TranslatedBlock* Emulator::findBlock(uint32_t pc){
+    if((pc & 0x3) != 0 || pc >= 0xFFFFFF00U) return nullptr;
+    auto& block = blocks[pc];
+    if(!block){
+        block = std::make_unique<TranslatedBlock>();
+        block->start = pc;
+        translateBlock(*block);
+    }else if(!block->valid()){
+        translateBlock(*block);
+    }
+    return block.get();
+}
+void Emulator::translateBlock(TranslatedBlock& block){
+    block.instructions.clear();
+    block.count = 0;
+    block.native = nullptr;
+    block.executions = 0;
+    block.pageGeneration = decodeCache.generation(block.start);
+    block.generation = __atomic_load_n(block.pageGeneration, __ATOMIC_ACQUIRE);
+
+    uint32_t page = block.start & ~PagedMemory::PAGE_MASK;
+    uint32_t address = block.start;
+    while(true){
+        uint32_t instruction = memory->readWord(address);
+        BlockInstruction translated;
+        instructionsDecoded++;
+        instructionDecode(instruction, translated.decoded);
+        fuseSequence(address, instruction, translated.decoded);
+        translated.nextPc = address + 4;
+        block.instructions.push_back(translated);
+        block.count += translated.decoded.count;
 
-uint32_t Emulator::instructionFetch(){
-    uint32_t instruction = readWordMem(gpr[PC]);
+        uint32_t nextAddress;
+        if(!continuesBlock(instruction, translated.decoded, address, nextAddress)) break;
+        //Blocks stay within one page, and don't run backwards
+        if((nextAddress & ~PagedMemory::PAGE_MASK) != page || nextAddress <= address) break;
+        if((nextAddress & 0x3) != 0 || nextAddress >= 0xFFFFFF00U) break;
+        address = nextAddress;
+    }
+}
+bool Emulator::continuesBlock(uint32_t instruction, const DecodedInstruction& di, uint32_t address, uint32_t& nextAddress){
+    uint8_t oc = (instruction >> 4) & 0x0F;
+    uint8_t mod = instruction & 0x0F;
+    nextAddress = address + di.length;
+    if(hasIllegalFields(oc, mod, di)) return false;
+    switch(oc){
+        case 0x4: //Xchg
+            return di.bd != PC && di.cd != PC;
+        case 0x5: //Arithmetic
+        case 0x6: //Logic
+        case 0x7: //Shift
+            return di.ad != PC;
+        case 0x8: //Store
+            return !(mod == 1 && di.ad == PC);
+        case 0xB: //Block copy and fill
+            return mod <= 1;
+        case 0xC: //Packed arithmetic
+            return mod < PackedLanes::OPERATIONS && di.ad != PC;
+        case 0x9: //Load
+            if(mod <= 3 && di.ad == PC) return false;
+            if((mod == 3 || mod == 7) && di.bd == PC && di.length == 4){
+                //gpr[B]<=gpr[B]+D moves PC by a known amount (skips over an inline literal)
+                nextAddress = address + 4 + di.disp;
+            }
+            return true;
+        default:
+            //Halt, int, wait, call, jumps and illegal opcodes
+            return false;
+    }
+}
+template<bool PROFILE, bool TRACE>
+void Emulator::executeBlock(const TranslatedBlock& block){
+    blockExit = false;
+    runningBlock = &block;
+    for(auto it = block.instructions.begin(); it != block.instructions.end(); ++it){
+        gpr[PC] = it->nextPc;
+        if constexpr (PROFILE || TRACE){
+            executeInstruction<PROFILE, TRACE>(it->nextPc - 4, it->decoded);
+        }else{
+            (this->*it->decoded.handler)(it->decoded);
+        }
+        if(blockExit){
+            //Stopped early, count the instructions up to here
+            for(auto done = block.instructions.begin(); done <= it; ++done) instructionCount += done->decoded.count;
+            runningBlock = nullptr;
+            return;
+        }
+    }
+    instructionCount += block.count;
+    runningBlock = nullptr;
+}
+const Emulator::DecodedInstruction& Emulator::instructionFetch(){
+    uint32_t pc = gpr[PC];
+    DecodedInstruction* decoded;
+    if((pc & 0x3) == 0 && pc < 0xFFFFFF00U){
+        decoded = decodeCache.lookup(pc);
+        if(!decoded){
+            //First execution since the page was (re)written
+            uint32_t generation;
+            decoded = &decodeCache.slot(pc, generation);
+            instructionsDecoded++;
+            uint32_t instruction = readWordMem(pc);
+            instructionDecode(instruction, *decoded);
+            fuseSequence(pc, instruction, *decoded);
+            decodeCache.validate(*decoded, generation);
+        }
+    }else{
+        decoded = &uncachedInstruction;
+        instructionsDecoded++;
+        instructionDecode(readWordMem(pc), *decoded);
+    }
     gpr[PC] += 4;
-    return instruction;
+    return *decoded;
+}
+template<size_t... OPCODES>
+constexpr std::array<Emulator::Handler, 256> Emulator::makeHandlerTable(std::index_sequence<OPCODES...>, std::false_type){
+    return {{ &Emulator::execute<static_cast<uint8_t>(OPCODES), false>... }};
+}
+template<size_t... OPCODES>
+constexpr std::array<Emulator::Handler, 256> Emulator::makeHandlerTable(std::index_sequence<OPCODES...>, std::true_type){
+    return {{ &Emulator::execute<static_cast<uint8_t>(OPCODES), true>... }};
 }
-void Emulator::instructionDecodeAndExecute(uint32_t instruction){
+void Emulator::instructionDecode(uint32_t instruction, DecodedInstruction& decoded){
+    //Handlers indexed by the instruction's first byte (oc << 4 | mod)
+    static constexpr std::array<Handler, 256> handlers =
+        makeHandlerTable(std::make_index_sequence<256>{}, std::false_type{});
+    static constexpr std::array<Handler, 256> illegalFieldHandlers =
+        makeHandlerTable(std::make_index_sequence<256>{}, std::true_type{});
+
     uint8_t byte0 = static_cast<uint8_t>((instruction >> 0) & 0xFF);
     uint8_t byte1 = static_cast<uint8_t>((instruction >> 8) & 0xFF);
     uint8_t byte2 = static_cast<uint8_t>((instruction >> 16) & 0xFF);
@@ -102,318 +846,492 @@ void Emulator::instructionDecodeAndExecute(uint32_t instruction){
     uint8_t oc = byte0 >> 4;
     uint8_t mod = byte0 & 0x0F;
     //byte1: a | b
-    uint8_t a = byte1 >> 4;
-    uint8_t b = byte1 & 0x0F;
+    decoded.a = byte1 >> 4;
+    decoded.b = byte1 & 0x0F;
     //byte2: c | disp11..8
-    uint8_t c = byte2 >> 4;
+    decoded.c = byte2 >> 4;
     //byte3: disp7..0
-    uint16_t disp = (static_cast<uint16_t>(byte2 & 0x0F)<<8) | byte3; 
-    if (disp & 0x800) disp |= 0xF000; //extend sign if disp was negative
+    int32_t disp = ((byte2 & 0x0F) << 8) | byte3;
+    if (disp & 0x800) disp -= 0x1000; //extend sign if disp was negative
+    decoded.disp = disp;
+    decoded.length = 4;
+    decoded.count = 1;
+    decoded.literal = 0;
+    decoded.word = instruction;
+
+    //Writes into r0 are discarded
+    decoded.ad = decoded.a == 0 ? SINK : decoded.a;
+    decoded.bd = decoded.b == 0 ? SINK : decoded.b;
+    decoded.cd = decoded.c == 0 ? SINK : decoded.c;
 
-    if(oc == 0x0){
+    decoded.handler = hasIllegalFields(oc, mod, decoded) ? illegalFieldHandlers[byte0] : handlers[byte0];
+    traceDecode(oc, mod, decoded);
+}
+void Emulator::fuseSequence(uint32_t address, uint32_t instruction, DecodedInstruction& decoded){
+    //Words of the sequence have to be in the instruction's page (outside the mapped address space),
+    //so that a write into any of them drops the fused instruction with the rest of the page
+    auto fits = [address](uint32_t words){
+        uint32_t last = address + 4 * (words - 1);
+        return (last & ~PagedMemory::PAGE_MASK) == (address & ~PagedMemory::PAGE_MASK) && last < 0xFFFFFF00U;
+    };
+    //jmp PC+4 (30 F0 00 04), skipping the literal behind call, beq/bne/bgt and st
+    constexpr uint32_t SKIP_LITERAL = 0x0400F030;
+
+    uint8_t gpr = (instruction >> 12) & 0x0F;
+    if((instruction & 0xFFFF0FFF) == 0x04000F93 && gpr != PC){
+        //ld: 93 <gpr><PC> 00 04, <literal>
+        if(fits(3) && gpr != 0 && memory->readWord(address + 8) == (0x00000092u | gpr << 12 | gpr << 8)){
+            //ld mem: followed by 92 <gpr><gpr> 00 00
+            decoded.handler = &Emulator::executeLoadMemoryLiteral;
+            decoded.length = 12;
+            decoded.count = 2;
+        }else if(fits(2)){
+            //ld $imm
+            decoded.handler = &Emulator::executeLoadLiteral;
+            decoded.length = 8;
+        }else{
+            return;
+        }
+        decoded.literal = memory->readWord(address + 4);
+    }else if(instruction == 0x0000F038 && fits(2)){
+        //jmp: 38 <PC>0 00 00, <literal>
+        decoded.handler = &Emulator::executeJumpLiteral;
+        decoded.length = 8;
+        decoded.literal = memory->readWord(address + 4);
+        if(decoded.literal == address) decoded.handler = &Emulator::executeIdleLoop;
+    }else if(fits(3) && memory->readWord(address + 4) == SKIP_LITERAL){
+        if(instruction == 0x0400F021){
+            //call: 21 <PC>0 00 04, 30 <PC>0 00 04, <literal>
+            decoded.handler = &Emulator::executeCallLiteral;
+        }else if((instruction & 0xFF0FF0FF) == 0x0400F039){
+            //beq: 39 <PC><gpr1> <gpr2>0 04, 30 <PC>0 00 04, <literal>
+            decoded.handler = decoded.b == decoded.c && memory->readWord(address + 8) == address
+                ? &Emulator::executeIdleLoop : &Emulator::executeBranchLiteral<1>;
+        }else if((instruction & 0xFF0FF0FF) == 0x0400F03A){
+            //bne
+            decoded.handler = &Emulator::executeBranchLiteral<2>;
+        }else if((instruction & 0xFF0FF0FF) == 0x0400F03B){
+            //bgt
+            decoded.handler = &Emulator::executeBranchLiteral<3>;
+        }else if((instruction & 0xFF0FFFFF) == 0x0400F082){
+            //st: 82 <PC>0 <gpr>0 04, 30 <PC>0 00 04, <literal>
+            decoded.handler = &Emulator::executeStoreLiteral;
+            decoded.count = 2;
+        }else{
+            return;
+        }
+        decoded.length = 12;
+        decoded.literal = memory->readWord(address + 8);
+    }
+}
+bool Emulator::hasIllegalFields(uint8_t oc, uint8_t mod, const DecodedInstruction& di){
+    switch(oc){
+        case 0x0: //Halt
+        case 0x1: //Software interrupt
+        case 0xA: //Wait
+            return mod != 0 || di.a != 0 || di.b != 0 || di.c != 0 || di.disp != 0;
+        case 0x2: //Call
+            return di.c != 0;
+        case 0x4: //Xchg
+            return mod != 0 || di.a != 0 || di.disp != 0;
+        case 0x5: //Arithmetic
+        case 0x6: //Logic
+        case 0x7: //Shift
+        case 0xB: //Block copy and fill
+        case 0xC: //Packed arithmetic
+            return di.disp != 0;
+        default:
+            return false;
+    }
+}
+template<uint8_t OPCODE, bool ILLEGAL_FIELDS>
+void Emulator::execute(const DecodedInstruction& di){
+    constexpr uint8_t OC = OPCODE >> 4;
+    constexpr uint8_t MOD = OPCODE & 0x0F;
+    if constexpr (ILLEGAL_FIELDS){
+        //The instruction is still executed, as if the fields were allowed
+        illegalInstructionInterrupt();
+    }
+    if constexpr (OC == 0x0){
         //Halt execution
-        executeHalt(mod,a,b,c,disp);
-    }else if(oc == 0x1){
+        executeHalt(di);
+    }else if constexpr (OC == 0x1){
         //Software interrupt
-        executeInt(mod,a,b,c,disp);
-    }else if(oc == 0x2){
+        executeInt(di);
+    }else if constexpr (OC == 0x2){
         //Call
-        executeCall(mod,a,b,c,disp);
-    }else if(oc == 0x3){
+        executeCall<MOD>(di);
+    }else if constexpr (OC == 0x3){
         //Jump
-        executeJump(mod,a,b,c,disp);
-    }else if(oc == 0x4){
+        executeJump<MOD>(di);
+    }else if constexpr (OC == 0x4){
         //Xchg
-        executeXchg(mod,a,b,c,disp);
-    }else if(oc == 0x5){
+        executeXchg(di);
+    }else if constexpr (OC == 0x5){
         //Arithmetic
-        executeArithmetic(mod,a,b,c,disp);
-    }else if(oc == 0x6){
+        executeArithmetic<MOD>(di);
+    }else if constexpr (OC == 0x6){
         //Logic
-        executeLogic(mod,a,b,c,disp);
-    }else if(oc == 0x7){
+        executeLogic<MOD>(di);
+    }else if constexpr (OC == 0x7){
         //Shift
-        executeShift(mod,a,b,c,disp);
-    }else if(oc == 0x8){
+        executeShift<MOD>(di);
+    }else if constexpr (OC == 0x8){
         //Store
-        executeStore(mod,a,b,c,disp);
-    }else if(oc == 0x9){
+        executeStore<MOD>(di);
+    }else if constexpr (OC == 0x9){
         //Load
-        executeLoad(mod,a,b,c,disp);
+        executeLoad<MOD>(di);
+    }else if constexpr (OC == 0xA){
+        //Wait for interrupt
+        executeWait(di);
+    }else if constexpr (OC == 0xB){
+        //Block copy and fill
+        executeMemoryBlock<MOD>(di);
+    }else if constexpr (OC == 0xC){
+        //Packed arithmetic
+        executePacked<MOD>(di);
     }else{
-        illegalInstructionInterrupt();
+        executeIllegal(di);
     }
 }
-void Emulator::handleInterrupts(){
-    if(illegalInstruction){
-        //push status
-        gpr[SP] -= 4;
-        writeWordMem(gpr[SP], csr[STATUS]);
-
-        //push pc
-        gpr[SP] -= 4;
-        writeWordMem(gpr[SP], gpr[PC]);
-
-        //cause <= 1
-        csr[CAUSE] = 1;
-
+void Emulator::takeInterrupt(){
+    uint32_t pending = pendingInterrupts.load(std::memory_order_relaxed);
+    uint32_t interrupt;
+    int cause;
+    int status;
+    if(pending & ILLEGAL_INTERRUPT){
+        interrupt = ILLEGAL_INTERRUPT;
+        cause = 1;
         //status <= status|(0x4) mask all interrupts
-        csr[STATUS] = csr[STATUS] | (0x4);
-
-        //pc <= handler
-        gpr[PC] = csr[HANDLER];
-
-        illegalInstruction = false;
-    }
-    else if(softwareInterrupt){
-        //push status
-        gpr[SP] -= 4;
-        writeWordMem(gpr[SP], csr[STATUS]);
-
-        //push pc
-        gpr[SP] -= 4;
-        writeWordMem(gpr[SP], gpr[PC]);
-
-        //cause <= 4
-        csr[CAUSE] = 4;
-
+        status = csr[STATUS] | (0x4);
+    }else if(pending & SOFTWARE_INTERRUPT){
+        interrupt = SOFTWARE_INTERRUPT;
+        cause = 4;
         //status <= status&(~0x1)
-        csr[STATUS] = csr[STATUS] & (~0x1);
-
-        //pc <= handler
-        gpr[PC] = csr[HANDLER];
-
-        softwareInterrupt = false;
+        status = csr[STATUS] & (~0x1);
+    }else if(csr[STATUS] & 0x4){
+        //Globally masked
+        return;
+    }else if((pending & TIMER_INTERRUPT) && !(csr[STATUS] & 0x1)){
+        interrupt = TIMER_INTERRUPT;
+        cause = 2;
+        status = csr[STATUS] | (0x4);
+    }else if((pending & TERMINAL_INTERRUPT) && !(csr[STATUS] & 0x2)){
+        interrupt = TERMINAL_INTERRUPT;
+        cause = 3;
+        status = csr[STATUS] | (0x4);
+    }else if((pending & IPI_INTERRUPT) && !(csr[STATUS] & 0x8)){
+        interrupt = IPI_INTERRUPT;
+        cause = 5;
+        status = csr[STATUS] | (0x4);
+    }else if((pending & DMA_INTERRUPT) && !(csr[STATUS] & 0x10)){
+        interrupt = DMA_INTERRUPT;
+        cause = 6;
+        status = csr[STATUS] | (0x4);
+    }else{
+        //Only masked interrupts are pending
+        return;
     }
-    else if(!(csr[STATUS] & 0x4)){//if not globally masked
+    //Acquire pairs with raiseInterrupt(), for the terminal's queued input
+    pendingInterrupts.fetch_and(~interrupt, std::memory_order_acq_rel);
+    //A terminal interrupt without a character left (they all went with earlier interrupts) is dropped
+    if(interrupt == TERMINAL_INTERRUPT && !latchTerminalInput()) return;
 
-        if(timerInterrupt && !(csr[STATUS] & 0x1)){
-            //push status
-            gpr[SP] -= 4;
-            writeWordMem(gpr[SP], csr[STATUS]);
+    //push status
+    gpr[SP] -= 4;
+    writeWordMem(gpr[SP], csr[STATUS]);
 
-            //push pc
-            gpr[SP] -= 4;
-            writeWordMem(gpr[SP], gpr[PC]);
+    //push pc
+    gpr[SP] -= 4;
+    writeWordMem(gpr[SP], gpr[PC]);
 
-            //cause <= 2
-            csr[CAUSE] = 2;
+    csr[CAUSE] = cause;
+    csr[STATUS] = status;
+    interruptsTaken++;
+    if(profiler) profiler->interrupt(cause, csr[HANDLER]);
 
-            //status <= status|(0x4) mask all interrupts
-            csr[STATUS] = csr[STATUS] | (0x4);
-
-            //pc <= handler
-            gpr[PC] = csr[HANDLER];
-            timerInterrupt = false;
-        }else if(terminalInterrupt && !(csr[STATUS] & 0x2)){
-            //push status
-            gpr[SP] -= 4;
-            writeWordMem(gpr[SP], csr[STATUS]);
-
-            //push pc
-            gpr[SP] -= 4;
-            writeWordMem(gpr[SP], gpr[PC]);
-
-            //cause <= 3
-            csr[CAUSE] = 3;
-
-            //status <= status|(0x4) mask all interrupts
-            csr[STATUS] = csr[STATUS] | (0x4);
+    //pc <= handler
+    gpr[PC] = csr[HANDLER];
+}
 
-            //pc <= handler
-            gpr[PC] = csr[HANDLER];
-            terminalInterrupt = false;
-        }
+bool Emulator::latchTerminalInput(){
+    if(headless){
+        if(headlessInputPosition == headlessInput.size()) return false;
+        term_in = headlessInput[headlessInputPosition++];
+        //Each character gets its own interrupt, the next one as soon as this one is taken
+        if(headlessInputPosition < headlessInput.size()) raiseInterrupt(TERMINAL_INTERRUPT);
+        return true;
     }
+    uint8_t ch;
+    if(!terminalInput.pop(ch)) return false;
+    term_in = ch;
+    //There is room for input again
+    if(inputStalled) ringDoorbell();
+    //Each queued character gets its own interrupt
+    if(!terminalInput.empty()) raiseInterrupt(TERMINAL_INTERRUPT);
+    return true;
 }
 
-void Emulator::executeHalt(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(mod != 0 || a != 0 || b != 0 || c != 0 || disp != 0){
-        illegalInstructionInterrupt();
-    }
+void Emulator::executeHalt(const DecodedInstruction& di){
     emulatorRunning = false;
+    blockExit = true;
 }
-void Emulator::executeInt(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(mod != 0 || a != 0 || b != 0 || c != 0 || disp != 0){
-        illegalInstructionInterrupt();
-    }
-    softwareInterrupt = true;
-    
+void Emulator::executeWait(const DecodedInstruction& di){
+    //Sleep until an interrupt can be taken, then go on after the instruction
+    enterIdle();
 }
-void Emulator::executeCall(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(c != 0){
-        illegalInstructionInterrupt();
-    }
-
-    if(mod == 0){
+void Emulator::executeInt(const DecodedInstruction& di){
+    raiseInterrupt(SOFTWARE_INTERRUPT);
+    blockExit = true;
+}
+template<uint8_t MOD>
+void Emulator::executeCall(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //push pc
         gpr[SP] -= 4;
         writeWordMem(gpr[SP], gpr[PC]);
         //pc<=gpr[A]+gpr[B]+D
-        gpr[PC] = gpr[a] + gpr[b] + static_cast<int16_t>(disp);
-    }else if(mod == 1){
+        gpr[PC] = gpr[di.a] + gpr[di.b] + di.disp;
+        if(profiler) profiler->call(gpr[PC]);
+    }else if constexpr (MOD == 1){
         //push pc
         gpr[SP] -= 4;
         writeWordMem(gpr[SP], gpr[PC]);
         //pc<=mem32[gpr[A]+gpr[B]+D]
-        gpr[PC] = readWordMem(gpr[a] + gpr[b] + static_cast<int16_t>(disp));
+        gpr[PC] = readWordMem(gpr[di.a] + gpr[di.b] + di.disp);
+        if(profiler) profiler->call(gpr[PC]);
     }else{
         illegalInstructionInterrupt();
     }
 }
-void Emulator::executeJump(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(mod == 0){
+template<uint8_t MOD>
+void Emulator::executeJump(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //pc<=gpr[A]+D;
-        gpr[PC] = gpr[a] + static_cast<int16_t>(disp);
-    }else if(mod == 1){
+        gpr[PC] = gpr[di.a] + di.disp;
+    }else if constexpr (MOD == 1){
         //if (gpr[B] == gpr[C]) pc<=gpr[A]+D;
-        if(gpr[b] == gpr[c]) gpr[PC] = gpr[a] + static_cast<int16_t>(disp);
-    }else if(mod == 2){
+        if(gpr[di.b] == gpr[di.c]) gpr[PC] = gpr[di.a] + di.disp;
+    }else if constexpr (MOD == 2){
         //if (gpr[B] != gpr[C]) pc<=gpr[A]+D;
-        if(gpr[b] != gpr[c]) gpr[PC] = gpr[a] + static_cast<int16_t>(disp);
-    }else if(mod == 3){
+        if(gpr[di.b] != gpr[di.c]) gpr[PC] = gpr[di.a] + di.disp;
+    }else if constexpr (MOD == 3){
         //if (gpr[B] signed> gpr[C]) pc<=gpr[A]+D;
-        if(static_cast<int32_t>(gpr[b]) > static_cast<int32_t>(gpr[c]))
-            gpr[PC] = gpr[a] + static_cast<int16_t>(disp);
-    }else if(mod == 8){
+        if(static_cast<int32_t>(gpr[di.b]) > static_cast<int32_t>(gpr[di.c]))
+            gpr[PC] = gpr[di.a] + di.disp;
+    }else if constexpr (MOD == 8){
         //pc<=mem32[gpr[A]+D];
-        gpr[PC] = readWordMem(gpr[a] + static_cast<int16_t>(disp));
-    }else if(mod == 9){
+        gpr[PC] = readWordMem(gpr[di.a] + di.disp);
+    }else if constexpr (MOD == 9){
         //if (gpr[B] == gpr[C]) pc<=mem32[gpr[A]+D];
-        if(gpr[b] == gpr[c])
-            gpr[PC] = readWordMem(gpr[a] + static_cast<int16_t>(disp));
-    }else if(mod == 10){
+        if(gpr[di.b] == gpr[di.c])
+            gpr[PC] = readWordMem(gpr[di.a] + di.disp);
+    }else if constexpr (MOD == 10){
         //if (gpr[B] != gpr[C]) pc<=mem32[gpr[A]+D];
-        if(gpr[b] != gpr[c])
-            gpr[PC] = readWordMem(gpr[a] + static_cast<int16_t>(disp));
-    }else if(mod == 11){
+        if(gpr[di.b] != gpr[di.c])
+            gpr[PC] = readWordMem(gpr[di.a] + di.disp);
+    }else if constexpr (MOD == 11){
         //if (gpr[B] signed> gpr[C]) pc<=mem32[gpr[A]+D];
-        if(static_cast<int32_t>(gpr[b]) > static_cast<int32_t>(gpr[c]))
-            gpr[PC] = readWordMem(gpr[a] + static_cast<int16_t>(disp));
+        if(static_cast<int32_t>(gpr[di.b]) > static_cast<int32_t>(gpr[di.c]))
+            gpr[PC] = readWordMem(gpr[di.a] + di.disp);
     }else{
         illegalInstructionInterrupt();
     }
-
-    
 }
-void Emulator::executeXchg(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(mod != 0 || a != 0 || disp != 0){
-        illegalInstructionInterrupt();
-    }
+void Emulator::executeXchg(const DecodedInstruction& di){
     //temp<=gpr[B]; gpr[B]<=gpr[C]; gpr[C]<=temp;
-    int temp = gpr[b];
-    gpr[b] = (b == 0) ? 0 :gpr[c];
-    gpr[c] = (c == 0) ? 0 :temp;
-
+    int temp = gpr[di.b];
+    gpr[di.bd] = gpr[di.c];
+    gpr[di.cd] = temp;
 }
-void Emulator::executeArithmetic(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(disp != 0){
-        illegalInstructionInterrupt();
-    }
-    if(mod == 0){
+template<uint8_t MOD>
+void Emulator::executeArithmetic(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //gpr[A]<=gpr[B] + gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] + gpr[c];
-    }else if(mod == 1){
+        gpr[di.ad] = gpr[di.b] + gpr[di.c];
+    }else if constexpr (MOD == 1){
         //gpr[A]<=gpr[B] - gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] - gpr[c];
-    }else if(mod == 2){
+        gpr[di.ad] = gpr[di.b] - gpr[di.c];
+    }else if constexpr (MOD == 2){
         //gpr[A]<=gpr[B] * gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] * gpr[c];
-    }else if(mod == 3){
+        gpr[di.ad] = gpr[di.b] * gpr[di.c];
+    }else if constexpr (MOD == 3){
         //gpr[A]<=gpr[B] / gpr[C];
-        if(gpr[c] != 0){
-            gpr[a] = (a == 0) ? 0 :gpr[b] / gpr[c];
+        if(gpr[di.c] != 0){
+            gpr[di.ad] = gpr[di.b] / gpr[di.c];
         }else{
             illegalInstructionInterrupt();
         }
-        
     }else{
         illegalInstructionInterrupt();
     }
 }
-void Emulator::executeLogic(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(disp != 0){
-        illegalInstructionInterrupt();
-    }
-    if(mod == 0){
+template<uint8_t MOD>
+void Emulator::executeLogic(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //gpr[A]<=~gpr[B];
-        gpr[a] = (a == 0) ? 0 :~gpr[b];
-    }else if(mod == 1){
+        gpr[di.ad] = ~gpr[di.b];
+    }else if constexpr (MOD == 1){
         //gpr[A]<=gpr[B] & gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] & gpr[c];
-    }else if(mod == 2){
+        gpr[di.ad] = gpr[di.b] & gpr[di.c];
+    }else if constexpr (MOD == 2){
         //gpr[A]<=gpr[B] | gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] | gpr[c];
-    }else if(mod == 3){
+        gpr[di.ad] = gpr[di.b] | gpr[di.c];
+    }else if constexpr (MOD == 3){
         //gpr[A]<=gpr[B] ^ gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] ^ gpr[c];
+        gpr[di.ad] = gpr[di.b] ^ gpr[di.c];
     }else{
         illegalInstructionInterrupt();
     }
 }
-void Emulator::executeShift(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(disp != 0){
-        illegalInstructionInterrupt();
-    }
-    if(mod == 0){
+template<uint8_t MOD>
+void Emulator::executeShift(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //gpr[A]<=gpr[B] << gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] << gpr[c];
-    }else if(mod == 1){
+        gpr[di.ad] = gpr[di.b] << gpr[di.c];
+    }else if constexpr (MOD == 1){
         //gpr[A]<=gpr[B] >> gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[b] >> gpr[c];
+        gpr[di.ad] = gpr[di.b] >> gpr[di.c];
     }else{
         illegalInstructionInterrupt();
     }
 }
-void Emulator::executeStore(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(mod == 0){
+template<uint8_t MOD>
+void Emulator::executeStore(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //mem32[gpr[A]+gpr[B]+D]<=gpr[C];
-        writeWordMem(gpr[a] + gpr[b] + static_cast<int16_t>(disp), gpr[c]);
-    }else if(mod == 2){
+        writeWordMem(gpr[di.a] + gpr[di.b] + di.disp, gpr[di.c]);
+    }else if constexpr (MOD == 2){
         //mem32[mem32[gpr[A]+gpr[B]+D]]<=gpr[C];
-        writeWordMem(readWordMem(gpr[a] + gpr[b] + static_cast<int16_t>(disp)), gpr[c]);
-    }else if(mod == 1){
+        writeWordMem(readWordMem(gpr[di.a] + gpr[di.b] + di.disp), gpr[di.c]);
+    }else if constexpr (MOD == 1){
         //gpr[A]<=gpr[A]+D; mem32[gpr[A]]<=gpr[C];
-        gpr[a] = (a == 0) ? 0 :gpr[a] + static_cast<int16_t>(disp);
-        writeWordMem(gpr[a], gpr[c]);
+        gpr[di.ad] = gpr[di.a] + di.disp;
+        writeWordMem(gpr[di.a], gpr[di.c]);
     }else{
         illegalInstructionInterrupt();
     }
 }
-void Emulator::executeLoad(uint8_t mod, uint8_t a, uint8_t b, uint8_t c, uint16_t disp){
-    if(mod == 0){
+template<uint8_t MOD>
+void Emulator::executeLoad(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
         //gpr[A]<=csr[B];
-        gpr[a] = (a == 0) ? 0 :csr[b];
-    }else if(mod == 1){
+        gpr[di.ad] = csr[di.b];
+    }else if constexpr (MOD == 1){
         //gpr[A]<=gpr[B]+D;
-        gpr[a] = (a == 0) ? 0 :gpr[b] + static_cast<int16_t>(disp);
-    }else if(mod == 2){
+        gpr[di.ad] = gpr[di.b] + di.disp;
+    }else if constexpr (MOD == 2){
         //gpr[A]<=mem32[gpr[B]+gpr[C]+D];
-        gpr[a] = (a == 0) ? 0 :readWordMem(gpr[b] + gpr[c] + static_cast<int16_t>(disp));
-    }else if(mod == 3){
+        gpr[di.ad] = readWordMem(gpr[di.b] + gpr[di.c] + di.disp);
+    }else if constexpr (MOD == 3){
         //gpr[A]<=mem32[gpr[B]]; gpr[B]<=gpr[B]+D;
-        gpr[a] = (a == 0) ? 0 :readWordMem(gpr[b]);
-        gpr[b] = (b == 0) ? 0 :gpr[b] + static_cast<int16_t>(disp);
-    }else if(mod == 4){
+        gpr[di.ad] = readWordMem(gpr[di.b]);
+        gpr[di.bd] = gpr[di.b] + di.disp;
+        //pop pc ends ret and iret
+        if(di.a == PC && profiler) profiler->ret();
+    }else if constexpr (MOD == 4){
         //csr[A]<=gpr[B];
-        csr[a] = gpr[b];
-    }else if(mod == 5){
+        csr[di.a] = gpr[di.b];
+        csrWritten(di.a);
+    }else if constexpr (MOD == 5){
         //csr[A]<=csr[B]|D;
-        csr[a] = csr[b] | disp;
-    }else if(mod == 6){
+        csr[di.a] = csr[di.b] | static_cast<uint16_t>(di.disp);
+        csrWritten(di.a);
+    }else if constexpr (MOD == 6){
         //csr[A]<=mem32[gpr[B]+gpr[C]+D];
-        csr[a] = readWordMem(gpr[b] + gpr[c] + static_cast<int16_t>(disp));
-    }else if(mod == 7){
+        csr[di.a] = readWordMem(gpr[di.b] + gpr[di.c] + di.disp);
+        csrWritten(di.a);
+    }else if constexpr (MOD == 7){
         //csr[A]<=mem32[gpr[B]]; gpr[B]<=gpr[B]+D;
-        csr[a] = readWordMem(gpr[b]);
-        gpr[b] = (b == 0) ? 0 :gpr[b] + static_cast<int16_t>(disp);
+        csr[di.a] = readWordMem(gpr[di.b]);
+        gpr[di.bd] = gpr[di.b] + di.disp;
+        csrWritten(di.a);
+    }else{
+        illegalInstructionInterrupt();
+    }
+}
+template<uint8_t MOD>
+void Emulator::executePacked(const DecodedInstruction& di){
+    if constexpr (MOD < PackedLanes::OPERATIONS){
+        //gpr[A]<=gpr[B] op gpr[C], lane by lane;
+        gpr[di.ad] = PackedLanes::apply<MOD>(gpr[di.b], gpr[di.c]);
+    }else{
+        illegalInstructionInterrupt();
+    }
+}
+template<uint8_t MOD>
+void Emulator::executeMemoryBlock(const DecodedInstruction& di){
+    if constexpr (MOD == 0){
+        //mem8[gpr[A]..gpr[A]+gpr[C]-1]<=mem8[gpr[B]..gpr[B]+gpr[C]-1];
+        copyMemory(gpr[di.a], gpr[di.b], gpr[di.c]);
+    }else if constexpr (MOD == 1){
+        //mem8[gpr[A]..gpr[A]+gpr[C]-1]<=gpr[B];
+        fillMemory(gpr[di.a], static_cast<uint8_t>(gpr[di.b]), gpr[di.c]);
     }else{
         illegalInstructionInterrupt();
     }
 }
+void Emulator::executeIllegal(const DecodedInstruction& di){
+    illegalInstructionInterrupt();
+}
+
+void Emulator::executeLoadLiteral(const DecodedInstruction& di){
+    //gpr[A]<=literal; pc<=pc+4;
+    gpr[di.ad] = di.literal;
+    gpr[PC] += 4;
+}
+void Emulator::executeLoadMemoryLiteral(const DecodedInstruction& di){
+    //gpr[A]<=literal; pc<=pc+8; gpr[A]<=mem32[gpr[A]];
+    gpr[di.ad] = di.literal;
+    gpr[PC] += 8;
+    gpr[di.ad] = readWordMem(di.literal);
+}
+void Emulator::executeCallLiteral(const DecodedInstruction& di){
+    //push pc; pc<=literal; (returns to the jump over the literal)
+    gpr[SP] -= 4;
+    writeWordMem(gpr[SP], gpr[PC]);
+    gpr[PC] = di.literal;
+    if(profiler) profiler->call(gpr[PC]);
+}
+void Emulator::executeJumpLiteral(const DecodedInstruction& di){
+    //pc<=literal;
+    gpr[PC] = di.literal;
+}
+template<uint8_t MOD>
+void Emulator::executeBranchLiteral(const DecodedInstruction& di){
+    bool taken;
+    if constexpr (MOD == 1){
+        taken = gpr[di.b] == gpr[di.c];
+    }else if constexpr (MOD == 2){
+        taken = gpr[di.b] != gpr[di.c];
+    }else{
+        taken = static_cast<int32_t>(gpr[di.b]) > static_cast<int32_t>(gpr[di.c]);
+    }
+    //if (condition) pc<=literal; else pc<=pc+8;
+    if(taken){
+        gpr[PC] = di.literal;
+    }else{
+        gpr[PC] += 8;
+        //The jump over the literal
+        instructionCount++;
+    }
+}
+void Emulator::executeStoreLiteral(const DecodedInstruction& di){
+    //mem32[literal]<=gpr[C]; pc<=pc+8;
+    writeWordMem(di.literal, gpr[di.c]);
+    gpr[PC] += 8;
+}
+
+void Emulator::executeIdleLoop(const DecodedInstruction& di){
+    //pc<=literal; (the loop's own address)
+    gpr[PC] = di.literal;
+    enterIdle();
+}
 
 void Emulator::illegalInstructionInterrupt(){
-    illegalInstruction = true;
+    raiseInterrupt(ILLEGAL_INTERRUPT);
+    blockExit = true;
 }
 
 
@@ -425,16 +1343,8 @@ uint8_t Emulator::readByteMem(uint32_t address) const{
             << std::hex << std::setw(8) << std::setfill('0') << address;
         throw std::runtime_error(oss.str());
     }
-    auto it = memory.find(address);
-    if (it == memory.end()) {
-        //Allow the program to read from wherever it wants
-        // std::ostringstream oss;
-        // oss << "Segmentation fault: invalid memory access at address 0x"
-        //     << std::hex << std::setw(8) << std::setfill('0') << address;
-        // throw std::runtime_error(oss.str());
-        return 0;
-    }
-    return it->second;
+    //Allow the program to read from wherever it wants, untouched memory reads as 0
+    return memory->readByte(address);
 }
 uint32_t Emulator::readWordMem(uint32_t address) const {
     if (address > 0xFFFFFFFFu - 3) {
@@ -443,26 +1353,73 @@ uint32_t Emulator::readWordMem(uint32_t address) const {
             << std::hex << std::setw(8) << std::setfill('0') << address;
         throw std::runtime_error(oss.str());
     }
-    if(address >= 0xFFFFFF00U){
-        if(address == TERM_IN_ADDR){
-            return term_in;
-        }else if(address == TIM_CFG_ADDR){
-            return tim_cfg;
-        }else{
-             std::ostringstream oss;
-            oss << "Read error: no matching mapped register for reading at address 0x"
-                << std::hex << std::setw(8) << std::setfill('0') << address;
-            throw std::runtime_error(oss.str());
-        }
+    if(address >= 0xFFFFFF00U) return readMappedWord(address);
+    if(address > 0xFFFFFF00U - 4){
+        //The word straddles into the mapped address space, let the byte accessor report it
+        for (uint32_t i = 0; i < 4; ++i) readByteMem(address + i);
     }
 
-    uint32_t value = 0;
-    for (int i = 0; i < 4; ++i) {
-        uint8_t byte = readByteMem(address + i);
-        value |= static_cast<uint32_t>(byte) << (8 * i);
+    return memory->readWord(address);
+}
+uint32_t Emulator::readMappedWord(uint32_t address) const{
+    //The devices belong to core 0
+    if(address == TERM_IN_ADDR){
+        return machine->term_in;
+    }else if(address == TIM_CFG_ADDR){
+        return machine->tim_cfg;
+    }else if(address == PERF_INSTRET_ADDR || address == PERF_CLOCK_ADDR){
+        //Read by the CPU thread alone, so no handshake with the device thread
+        uint64_t value = address == PERF_INSTRET_ADDR ? retiredInstructions() : clockNanoseconds();
+        counterHigh = static_cast<uint32_t>(value >> 32);
+        return static_cast<uint32_t>(value);
+    }else if(address == PERF_INSTRET_HI_ADDR || address == PERF_CLOCK_HI_ADDR){
+        return counterHigh;
+    }else if(address == PERF_INTERRUPTS_ADDR){
+        return interruptsTaken;
+    }else if(address == PERF_DECODES_ADDR){
+        return instructionsDecoded;
+    }else if(address == CORE_ID_ADDR){
+        return coreId;
+    }else if(address == CORE_COUNT_ADDR){
+        return coreCount;
+    }else if(address == SPINLOCK_ADDR){
+        //Reads 1 if it took the lock, 0 if some core holds it already
+        return machine->spinlock.exchange(1, std::memory_order_acquire) == 0 ? 1 : 0;
+    }else if(address == DMA_ADDRESS_ADDR){
+        return dmaAddress;
+    }else if(address == DMA_LENGTH_ADDR){
+        return dmaLength;
+    }else if(address == DMA_CONTROL_ADDR){
+        //Never busy: transfers are done by the time the write that starts them is
+        return 0;
+    }else{
+         std::ostringstream oss;
+        oss << "Read error: no matching mapped register for reading at address 0x"
+            << std::hex << std::setw(8) << std::setfill('0') << address;
+        throw std::runtime_error(oss.str());
     }
-
-    return value;
+}
+uint64_t Emulator::retiredInstructions() const{
+    uint64_t count = instructionCount;
+    if(runningBlock){
+        for(const auto& instruction: runningBlock->instructions){
+            //The executing instruction; a fused sequence may have moved PC over its words already
+            if(gpr[PC] - instruction.nextPc < instruction.decoded.length) break;
+            count += instruction.decoded.count;
+        }
+    }
+    return count;
+}
+uint64_t Emulator::clockNanoseconds() const{
+    if(virtualRate){
+        return instructionCount / virtualRate * 1000000000 + instructionCount % virtualRate * 1000000000 / virtualRate;
+    }
+    return monotonicNanoseconds() - clockStart;
+}
+uint64_t Emulator::monotonicNanoseconds(){
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
 }
 void Emulator::writeByteMem(uint32_t address, uint8_t value) {
     if(address >= 0xFFFFFF00U){
@@ -471,9 +1428,10 @@ void Emulator::writeByteMem(uint32_t address, uint8_t value) {
             << std::hex << std::setw(8) << std::setfill('0') << address;
         throw std::runtime_error(oss.str());
     }
-    memory[address] = value;
-
-    
+    memory->writeByte(address, value);
+    //Code on this page has to be decoded again, and the running block may have been overwritten
+    if(decodeCache.invalidate(address)) blockExit = true;
+    if(sharedCode) machine->invalidateCores(address, this);
 }
 void Emulator::writeWordMem(uint32_t address, uint32_t value) {
     // Ensure that writing 4 bytes doesn’t overflow the 32-bit address space
@@ -485,14 +1443,55 @@ void Emulator::writeWordMem(uint32_t address, uint32_t value) {
     }
     if(address >= 0xFFFFFF00U){
         if(address == TERM_OUT_ADDR){
-            while(terminalSignal) std::this_thread::yield();
-            term_out = value;
-            terminalSignal = true;
-            while(terminalSignal) std::this_thread::yield();
+            if(machine->parallelCores){
+                //The output queue takes a single producer
+                std::lock_guard<std::mutex> lock(machine->terminalLock);
+                machine->writeTerminal(static_cast<uint8_t>(value));
+            }else{
+                machine->writeTerminal(static_cast<uint8_t>(value));
+            }
             return;
         }else if(address == TIM_CFG_ADDR){
+            if(coreId != 0){
+                std::ostringstream oss;
+                oss << "Write error: only core 0 can configure the timer, written by core " << coreId;
+                throw std::runtime_error(oss.str());
+            }
             tim_cfg = value;
-            timerStart = true;
+            //The timer starts with the first write, later ones change the period of the next interrupt
+            if(timerStart.exchange(true)) return;
+            if(virtualRate){
+                timerDeadline = instructionCount + virtualTimerPeriod(value);
+                updateDeadline();
+            }else{
+                ringDoorbell();
+            }
+            return;
+        }else if(address == SNAPSHOT_ADDR){
+            //Taken once the instruction (or the running block) is done
+            if(snapshotTrigger == SNAPSHOT_ON_WRITE && snapshotArmed()){
+                snapshotDeadline = instructionCount;
+                updateDeadline();
+                blockExit = true;
+            }
+            return;
+        }else if(address == IPI_ADDR){
+            machine->interruptCores(value);
+            //Take one sent to itself right after this instruction
+            if(value & (1u << coreId)) blockExit = true;
+            return;
+        }else if(address == SPINLOCK_ADDR){
+            //Any write releases the lock
+            machine->spinlock.store(0, std::memory_order_release);
+            return;
+        }else if(address == DMA_ADDRESS_ADDR){
+            dmaAddress = value;
+            return;
+        }else if(address == DMA_LENGTH_ADDR){
+            dmaLength = value;
+            return;
+        }else if(address == DMA_CONTROL_ADDR){
+            terminalTransfer(value);
             return;
         }else{
              std::ostringstream oss;
@@ -501,110 +1500,330 @@ void Emulator::writeWordMem(uint32_t address, uint32_t value) {
             throw std::runtime_error(oss.str());
         }
     }
+    if(address > 0xFFFFFF00U - 4){
+        //The word straddles into the mapped address space, let the byte accessor report it
+        for (uint32_t i = 0; i < 4; ++i) writeByteMem(address + i, static_cast<uint8_t>(value >> (8 * i)));
+    }
 
     // Write in little endian order
-    for (int i = 0; i < 4; ++i) {
-        uint8_t byte = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
-        writeByteMem(address + i, byte);
+    memory->writeWord(address, value);
+    //Code on the written page(s) has to be decoded again, and the running block may have been overwritten
+    if(decodeCache.invalidate(address)) blockExit = true;
+    if(decodeCache.invalidate(address + 3)) blockExit = true;
+    if(sharedCode) machine->invalidateCores(address, this);
+}
+void Emulator::copyMemory(uint32_t destination, uint32_t source, uint32_t length){
+    checkBlockRange(source, length, "Read");
+    checkBlockRange(destination, length, "Write");
+    memory->copyBytes(destination, source, length);
+    rangeWritten(destination, length);
+}
+void Emulator::fillMemory(uint32_t destination, uint8_t value, uint32_t length){
+    checkBlockRange(destination, length, "Write");
+    memory->fillBytes(destination, value, length);
+    rangeWritten(destination, length);
+}
+void Emulator::checkBlockRange(uint32_t address, uint32_t length, const char* access){
+    if(static_cast<uint64_t>(address) + length <= 0xFFFFFF00U) return;
+    std::ostringstream oss;
+    oss << access << " error: block of " << length << " bytes at address 0x"
+        << std::hex << std::setw(8) << std::setfill('0') << address << " reaches into the mapped address space";
+    throw std::runtime_error(oss.str());
+}
+void Emulator::rangeWritten(uint32_t address, uint32_t length){
+    if(length == 0) return;
+    //Code on the written pages has to be decoded again, and the running block may have been overwritten
+    for(size_t offset = 0; offset < length; offset += PagedMemory::PAGE_SIZE){
+        if(decodeCache.invalidate(address + offset)) blockExit = true;
+        if(sharedCode) machine->invalidateCores(address + offset, this);
     }
+    if(decodeCache.invalidate(address + length - 1)) blockExit = true;
+    if(sharedCode) machine->invalidateCores(address + length - 1, this);
 }
-
-void Emulator::timer(){
-    //Busy wait until the timer is started
-    while(!timerStart && emulatorRunning) std::this_thread::yield();
-
-    while(emulatorRunning){
-        uint32_t cfg = tim_cfg;
-        uint32_t delay;
-        switch(cfg){
-            case 0x0: delay =   500; break;
-            case 0x1: delay =  1000; break;
-            case 0x2: delay =  1500; break;
-            case 0x3: delay =  2000; break;
-            case 0x4: delay =  5000; break;
-            case 0x5: delay = 10000; break;
-            case 0x6: delay = 30000; break;
-            case 0x7: delay = 60000; break;
-            default:
-                //If setting is unrecognized, set delay to 500ms
-                delay = 500; break;
+void Emulator::terminalTransfer(uint32_t control){
+    if(!(control & DMA_START)) return;
+    checkBlockRange(dmaAddress, dmaLength, "Read");
+    {
+        std::unique_lock<std::mutex> lock;
+        //The output queue takes a single producer
+        if(machine->parallelCores) lock = std::unique_lock<std::mutex>(machine->terminalLock);
+        //Straight out of the pages; those never written hold zeros
+        static const uint8_t zeros[PagedMemory::PAGE_SIZE] = {};
+        uint32_t address = dmaAddress;
+        uint32_t remaining = dmaLength;
+        while(remaining > 0){
+            uint32_t offset = address & PagedMemory::PAGE_MASK;
+            uint32_t chunk = std::min(remaining, PagedMemory::PAGE_SIZE - offset);
+            const uint8_t* page = memory->findPage(address);
+            machine->writeTerminal(page ? page + offset : zeros, chunk);
+            address += chunk;
+            remaining -= chunk;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
-        timerInterrupt = true;
+    }
+    if(control & DMA_INTERRUPT_ON_DONE){
+        raiseInterrupt(DMA_INTERRUPT);
+        //Taken right after this instruction
+        blockExit = true;
     }
 }
-
-void Emulator::terminal(){
-    struct termios oldt, newt;
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-
-    //Turn off canonical mode and echo
-    newt.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-    //Set stdin to non-blocking mode
-    int oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
-
-    //Main terminal loop
-    while (emulatorRunning) {
-        
-        //Check for input
-        char ch;
-        ssize_t n = read(STDIN_FILENO, &ch, 1);
-        if (n > 0) {
-            term_in = static_cast<uint8_t>(ch);
-            terminalInterrupt = true;
+void Emulator::writeTerminal(const uint8_t* data, size_t length){
+    if(headless){
+        headlessOutput->write(reinterpret_cast<const char*>(data), length);
+        return;
+    }
+    while(length > 0){
+        size_t pushed = terminalOutput.push(data, length);
+        if(pushed == 0){
+            std::this_thread::yield();
+            continue;
         }
+        if(terminalOutput.consumerIdle(pushed)) ringDoorbell();
+        data += pushed;
+        length -= pushed;
+    }
+}
+void Emulator::writeTerminal(uint8_t ch){
+    if(headless){
+        headlessOutput->put(static_cast<char>(ch));
+        return;
+    }
+    //Only stall while the terminal is behind by a whole queue
+    while(!terminalOutput.push(ch)) std::this_thread::yield();
+    if(terminalOutput.consumerIdle()) ringDoorbell();
+}
 
-        //Check for output
-        if (terminalSignal) {
-            std::cout << static_cast<char>((term_out) & 0xFF) << std::flush;
-            terminalSignal = false; //when terminalSignal is false the processor knows the terminal is done and not busy
-        }
-        std::this_thread::yield();
-    } 
-    //Restore terminal on exit
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    fcntl(STDIN_FILENO, F_SETFL, oldf);
+void Emulator::ringDoorbell(){
+    uint64_t one = 1;
+    ssize_t written = write(doorbell, &one, sizeof(one));
+    (void)written; //The counter can only overflow if the device thread stopped, and then nobody listens
+}
+uint32_t Emulator::timerPeriod(uint32_t cfg){
+    switch(cfg){
+        case 0x0: return   500;
+        case 0x1: return  1000;
+        case 0x2: return  1500;
+        case 0x3: return  2000;
+        case 0x4: return  5000;
+        case 0x5: return 10000;
+        case 0x6: return 30000;
+        case 0x7: return 60000;
+        default:
+            //If setting is unrecognized, set delay to 500ms
+            return 500;
+    }
+}
+uint64_t Emulator::virtualTimerPeriod(uint32_t cfg) const{
+    uint64_t period = timerPeriod(cfg) * virtualRate / 1000;
+    return period ? period : 1;
+}
+void Emulator::virtualTimerTick(){
+    raiseInterrupt(TIMER_INTERRUPT);
+    //A new setting takes effect from the next period on
+    timerDeadline += virtualTimerPeriod(tim_cfg);
+    //Don't make up for periods a long block ran past
+    if(timerDeadline <= instructionCount) timerDeadline = instructionCount + 1;
+}
+void Emulator::deadlineReached(){
+    if(idle){
+        idle = false;
+        waitForInterrupt();
+    }
+    if(instructionCount >= snapshotDeadline){
+        snapshotDeadline = UINT64_MAX;
+        snapshotReached();
+    }
+    if(instructionCount >= timerDeadline) virtualTimerTick();
+    if(instructionCount >= budgetDeadline) budgetReached();
+    if(instructionCount >= quantumDeadline){
+        //End of the core's turn, unless it just halted
+        quantumDeadline = UINT64_MAX;
+        quantumExpired = emulatorRunning;
+        emulatorRunning = false;
+        blockExit = true;
+    }
+    updateDeadline();
+}
+bool Emulator::interruptTakeable() const{
+    uint32_t pending = pendingInterrupts.load();
+    if(pending & (ILLEGAL_INTERRUPT | SOFTWARE_INTERRUPT)) return true;
+    if(csr[STATUS] & 0x4) return false;
+    return ((pending & TIMER_INTERRUPT) && !(csr[STATUS] & 0x1))
+        || ((pending & TERMINAL_INTERRUPT) && !(csr[STATUS] & 0x2))
+        || ((pending & IPI_INTERRUPT) && !(csr[STATUS] & 0x8))
+        || ((pending & DMA_INTERRUPT) && !(csr[STATUS] & 0x10));
 }
-void printUsage(const char* progName) {
-    std::cout << "Usage: " << progName << " <file>\n\n";
-    std::cout << "Options:\n";
-    std::cout << "  -h   Show this help message and exit\n\n";
-    std::cout << "Example:\n";
-    std::cout << "  " << progName << " program.hex\n\n";
+void Emulator::waitForInterrupt(){
+    if(interruptTakeable()) return;
+    if(virtualRate){
+        //Every pass through the loop retires an instruction, so it would run up to the next deadline;
+        //skip right there
+        uint64_t deadline = std::min({timerDeadline, snapshotDeadline, budgetEnd});
+        if(deadline != UINT64_MAX){
+            instructionCount = std::max(instructionCount, std::min(deadline, quantumDeadline));
+            return;
+        }
+    }
+    if(sharedCode){
+        //The other cores run on this thread: let them have the rest of the turn, runRoundRobin() sleeps once all of them idle
+        idleTurn = true;
+        quantumExpired = true;
+        emulatorRunning = false;
+        blockExit = true;
+        return;
+    }
+    if(!sleep(true)){
+        //Out of time, let budgetReached() stop the emulator
+        budgetDeadline = instructionCount;
+    }
 }
-int main(int argc, char **argv){
-    if (argc != 2) {
-        printUsage(argv[0]);
-        return 1;
+bool Emulator::sleep(bool interrupts){
+    std::unique_lock<std::mutex> lock(idleLock);
+    //Sequentially consistent with raiseInterrupt(): either it sees parked set, or interruptTakeable() sees its interrupt
+    parked.store(true);
+    bool inTime = true;
+    while(emulatorRunning && !(interrupts && interruptTakeable())){
+        if(budgetTimeEnd == UINT64_MAX){
+            idleSignal.wait(lock);
+        }else if(idleSignal.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(budgetTimeEnd)))
+            == std::cv_status::timeout){
+            inTime = false;
+            break;
+        }
     }
+    parked.store(false);
+    return inTime;
+}
+void Emulator::wake(){
+    //Taking the lock makes sure the CPU thread is either waiting or yet to look at what changed
+    { std::lock_guard<std::mutex> lock(idleLock); }
+    idleSignal.notify_all();
+}
+void Emulator::devices(){
+    //A headless run only needs the timer from this thread
+    struct termios oldt, newt;
+    int oldf = 0;
+    if (!headless) {
+        tcgetattr(STDIN_FILENO, &oldt);
+        newt = oldt;
 
-    std::string arg = argv[1];
-    if (arg == "-h") {
-        printUsage(argv[0]);
-        return 0;
+        //Turn off canonical mode and echo
+        newt.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &newt);
+
+        //Set stdin to non-blocking mode
+        oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
+        fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
     }
 
-    const std::string filename = arg;
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    auto watch = [epollFd](int fd){
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+    };
+    watch(doorbell);
+    watch(timerFd);
+    //Regular files and /dev/null can't be watched, but they never block either
+    bool inputOpen = !headless;
+    bool inputWatched = !headless && watch(STDIN_FILENO);
+    bool inputPollable = inputWatched;
+
+    bool timerArmed = false;
+    uint32_t timerCfg = 0;
+    auto armTimer = [&](){
+        timerCfg = tim_cfg;
+        uint32_t period = timerPeriod(timerCfg);
+        itimerspec spec{};
+        spec.it_value.tv_sec = period / 1000;
+        spec.it_value.tv_nsec = (period % 1000) * 1000000L;
+        spec.it_interval = spec.it_value;
+        timerfd_settime(timerFd, 0, &spec, nullptr);
+        timerArmed = true;
+    };
+    auto stopWatchingInput = [&](){
+        if (inputWatched) epoll_ctl(epollFd, EPOLL_CTL_DEL, STDIN_FILENO, nullptr);
+        inputWatched = false;
+    };
+    auto readInput = [&](){
+        size_t space = terminalInput.freeSpace();
+        if (space == 0) {
+            //Wait for the CPU to take some input; check again in case it did so meanwhile
+            inputStalled = true;
+            space = terminalInput.freeSpace();
+            if (space == 0) {
+                stopWatchingInput();
+                return;
+            }
+            inputStalled = false;
+        }
+        char buffer[256];
+        ssize_t n = read(STDIN_FILENO, buffer, std::min(space, sizeof(buffer)));
+        if (n > 0) {
+            for (ssize_t i = 0; i < n; i++) terminalInput.push(static_cast<uint8_t>(buffer[i]));
+            raiseInterrupt(TERMINAL_INTERRUPT);
+        } else if (n == 0) {
+            //End of input
+            inputOpen = false;
+            stopWatchingInput();
+        }
+    };
+    auto writeOutput = [&](){
+        char buffer[256];
+        size_t n;
+        uint8_t ch;
+        do {
+            n = 0;
+            while (n < sizeof(buffer) && terminalOutput.pop(ch)) buffer[n++] = static_cast<char>(ch);
+            std::cout.write(buffer, n);
+        } while (n == sizeof(buffer));
+        std::cout.flush();
+    };
 
-    Emulator emulator;
+    //Main device loop
+    while (devicesRunning) {
+        bool pollInput = inputOpen && !inputPollable && !inputStalled;
+        epoll_event events[3];
+        int n = epoll_wait(epollFd, events, 3, pollInput ? 0 : -1);
+        if (n < 0 && errno != EINTR) break;
 
-    try {
-        emulator.readFile(filename);
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Error reading file " << filename << ": " << e.what() << "\n";
-        return 1;
-    }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            uint64_t count;
+            if (fd == doorbell) {
+                ssize_t r = read(doorbell, &count, sizeof(count));
+                (void)r;
+            } else if (fd == timerFd) {
+                if (read(timerFd, &count, sizeof(count)) > 0) {
+                    raiseInterrupt(TIMER_INTERRUPT);
+                    //A new setting takes effect from the next period on
+                    if (tim_cfg != timerCfg) armTimer();
+                }
+            } else if (fd == STDIN_FILENO && inputOpen) {
+                readInput();
+            }
+        }
+        if (pollInput) readInput();
 
-    try {
-        emulator.emulate();
-    } catch (const std::runtime_error& e) {
-        std::cerr << "Emulation error: " << e.what() << "\n";
-        return 1;
+        //The CPU made room for more input
+        if (inputStalled && terminalInput.freeSpace() > 0) {
+            inputStalled = false;
+            if (inputOpen && inputPollable) inputWatched = watch(STDIN_FILENO);
+        }
+
+        //Timer started by the CPU
+        if (timerStart && !timerArmed) armTimer();
+
+        writeOutput();
     }
+    writeOutput();
+    close(timerFd);
+    close(epollFd);
 
-    return 0;
+    //Restore terminal on exit
+    if (!headless) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+        fcntl(STDIN_FILENO, F_SETFL, oldf);
+    }
 }
@@ -0,0 +1,297 @@
+#include "emulator.hpp"
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <memory>
+
+void printUsage(const char* progName) {
+    std::cout << "Usage: " << progName << " [options] <file>\n";
+    std::cout << "       " << progName << " [options] -restore=SNAPSHOT\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h           Show this help message and exit\n";
+    std::cout << "  -interpret   Execute one instruction at a time, without block translation\n";
+    std::cout << "  -no-jit      Run translated blocks without compiling the hot ones into native code\n";
+    std::cout << "  -perf-map    Describe the native code compiled while running in /tmp/perf-<pid>.map, for perf\n";
+    std::cout << "  -ips=RATE    Virtual time: run the timer at RATE instructions per second of emulated time,\n";
+    std::cout << "               raising its interrupts after a fixed number of instructions\n";
+    std::cout << "  -headless    Don't use the terminal: no input unless -input is given, output to stdout or -output\n";
+    std::cout << "  -input=FILE  Terminal input for -headless (- for standard input)\n";
+    std::cout << "  -output=FILE Terminal output for -headless\n";
+    std::cout << "  -snapshot=FILE  Save the state of the emulated machine into FILE (once)\n";
+    std::cout << "  -snapshot-at=WHEN  When to save it: halt (default), write (on a write to 0xFFFFFF20)\n";
+    std::cout << "               or a number of retired instructions\n";
+    std::cout << "  -restore=FILE  Start from a saved state instead of an executable\n";
+    std::cout << "  -fork=INPUT[,OUTPUT]  Stop at the -snapshot-at point (write or N) and go on in a headless copy of the machine\n";
+    std::cout << "               reading INPUT and writing OUTPUT (INPUT.out by default); repeat for more copies,\n";
+    std::cout << "               which run in parallel\n";
+    std::cout << "  -profile=FILE  Count retired instructions per address and write a hot spot report into FILE\n";
+    std::cout << "  -callgraph=FILE  Write the instructions retired by every call stack into FILE, as folded stacks\n";
+    std::cout << "  -map=FILE    Symbol map written by the linker (-map), to name addresses in reports\n";
+    std::cout << "  -trace=FILE  Record the last executed instructions and write them into FILE when emulation stops\n";
+    std::cout << "  -trace-last=N  How many instructions -trace keeps (1048576 by default, 268435456 at most)\n";
+    std::cout << "  -max-instructions=N  Stop once N instructions retired\n";
+    std::cout << "  -timeout=MS  Stop once MS milliseconds passed\n";
+    std::cout << "  -cores=N     Emulate N cores sharing memory, each on its own thread\n";
+    std::cout << "  -round-robin[=QUANTUM]  Run the cores on a single thread in turns of QUANTUM instructions\n";
+    std::cout << "               (10000 by default), so that runs repeat exactly\n\n";
+    std::cout << "Exit status:\n";
+    std::cout << "  0 if the processor halted, 1 if the file couldn't be read, 2 after a fatal emulation error,\n";
+    std::cout << "  3 if it was stopped by -max-instructions or -timeout\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " program.hex\n\n";
+}
+//Most entries -trace-last may ask for (4 GiB of trace ring)
+constexpr uint64_t MAX_TRACE_ENTRIES = uint64_t(1) << 28;
+//Value of a numeric option (decimal, hex or octal, as std::stoull reads it); throws std::invalid_argument
+//for negative numbers, which std::stoull would wrap around, and for anything after the number
+uint64_t parseNumber(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\n\v\f\r");
+    if (start != std::string::npos && text[start] == '-') throw std::invalid_argument(text);
+    size_t end;
+    uint64_t value = std::stoull(text, &end, 0);
+    if (end != text.size()) throw std::invalid_argument(text);
+    return value;
+}
+//Terminal files of a forked copy
+struct Fork {
+    std::string inputFile;
+    std::string outputFile;
+};
+//Run a headless copy of the stopped emulator for every fork, each on its own thread,
+//then print their final states in order; returns the exit status
+int runForks(const Emulator& parent, const std::vector<Fork>& forks) {
+    std::vector<std::unique_ptr<Emulator>> children;
+    std::vector<std::ostringstream> states(forks.size());
+    for (size_t i = 0; i < forks.size(); ++i) {
+        children.push_back(parent.fork());
+        children.back()->setHeadless(forks[i].inputFile, forks[i].outputFile);
+        children.back()->setStateOutput(states[i]);
+    }
+
+    std::vector<int> results(forks.size(), 2);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < forks.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            try {
+                results[i] = children[i]->emulate() ? 0 : 2;
+            } catch (const std::runtime_error& e) {
+                states[i] << "Emulation error: " << e.what() << "\n";
+            }
+        });
+    }
+    int status = 0;
+    for (size_t i = 0; i < forks.size(); ++i) {
+        threads[i].join();
+        std::cout << "\n== fork " << i << " (" << forks[i].inputFile << " -> " << forks[i].outputFile << ")";
+        std::cout << states[i].str();
+        if (results[i] != 0) status = results[i];
+    }
+    return status;
+}
+int main(int argc, char **argv){
+    std::string filename;
+    bool blockTranslation = true;
+    bool jit = true;
+    bool perfMap = false;
+    uint64_t instructionsPerSecond = 0;
+    bool headless = false;
+    std::string inputFile;
+    std::string outputFile;
+    std::string snapshotFile;
+    Emulator::SnapshotTrigger snapshotTrigger = Emulator::SNAPSHOT_AT_HALT;
+    uint64_t snapshotInstruction = 0;
+    std::string restoreFile;
+    std::vector<Fork> forks;
+    std::string profileFile;
+    std::string callGraphFile;
+    std::string mapFile;
+    std::string traceFile;
+    size_t traceEntries = 1 << 20;
+    uint64_t maxInstructions = 0;
+    uint64_t timeout = 0;
+    //Kept wide until it is range-checked, so that large values aren't cut down to a valid count
+    uint64_t cores = 1;
+    bool roundRobin = false;
+    uint64_t quantum = 10000;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg == "-interpret") {
+                blockTranslation = false;
+            } else if (arg == "-no-jit") {
+                jit = false;
+            } else if (arg == "-perf-map") {
+                perfMap = true;
+            } else if (arg.rfind("-ips=", 0) == 0) {
+                instructionsPerSecond = parseNumber(arg.substr(5));
+            } else if (arg == "-headless") {
+                headless = true;
+            } else if (arg.rfind("-input=", 0) == 0) {
+                inputFile = arg.substr(7);
+            } else if (arg.rfind("-output=", 0) == 0) {
+                outputFile = arg.substr(8);
+            } else if (arg.rfind("-snapshot=", 0) == 0) {
+                snapshotFile = arg.substr(10);
+            } else if (arg.rfind("-snapshot-at=", 0) == 0) {
+                std::string when = arg.substr(13);
+                if (when == "halt") {
+                    snapshotTrigger = Emulator::SNAPSHOT_AT_HALT;
+                } else if (when == "write") {
+                    snapshotTrigger = Emulator::SNAPSHOT_ON_WRITE;
+                } else {
+                    snapshotTrigger = Emulator::SNAPSHOT_AT_INSTRUCTION;
+                    snapshotInstruction = parseNumber(when);
+                }
+            } else if (arg.rfind("-restore=", 0) == 0) {
+                restoreFile = arg.substr(9);
+            } else if (arg.rfind("-profile=", 0) == 0) {
+                profileFile = arg.substr(9);
+            } else if (arg.rfind("-callgraph=", 0) == 0) {
+                callGraphFile = arg.substr(11);
+            } else if (arg.rfind("-map=", 0) == 0) {
+                mapFile = arg.substr(5);
+            } else if (arg.rfind("-trace=", 0) == 0) {
+                traceFile = arg.substr(7);
+            } else if (arg.rfind("-trace-last=", 0) == 0) {
+                traceEntries = parseNumber(arg.substr(12));
+                if (traceEntries > MAX_TRACE_ENTRIES) throw std::out_of_range(arg);
+            } else if (arg.rfind("-max-instructions=", 0) == 0) {
+                maxInstructions = parseNumber(arg.substr(18));
+            } else if (arg.rfind("-timeout=", 0) == 0) {
+                timeout = parseNumber(arg.substr(9));
+            } else if (arg.rfind("-cores=", 0) == 0) {
+                cores = parseNumber(arg.substr(7));
+            } else if (arg == "-round-robin") {
+                roundRobin = true;
+            } else if (arg.rfind("-round-robin=", 0) == 0) {
+                roundRobin = true;
+                quantum = parseNumber(arg.substr(13));
+            } else if (arg.rfind("-fork=", 0) == 0) {
+                std::string files = arg.substr(6);
+                size_t comma = files.find(',');
+                if (comma == std::string::npos) {
+                    forks.push_back({files, files + ".out"});
+                } else {
+                    forks.push_back({files.substr(0, comma), files.substr(comma + 1)});
+                }
+            } else if (filename.empty()) {
+                filename = arg;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {
+        //A number that parseNumber() couldn't parse, or that doesn't fit
+        std::cerr << "Invalid option value\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (filename.empty() == restoreFile.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!headless && (!inputFile.empty() || !outputFile.empty())) {
+        std::cerr << "-input and -output require -headless\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!forks.empty() && !snapshotFile.empty()) {
+        std::cerr << "-fork and -snapshot can't be used together\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    //A halted machine has nothing left for its copies to run
+    if (!forks.empty() && snapshotTrigger == Emulator::SNAPSHOT_AT_HALT) {
+        std::cerr << "-fork requires -snapshot-at=write or -snapshot-at=N\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (cores == 0 || cores > 32) {
+        std::cerr << "-cores takes 1 to 32 cores\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (cores > 1 && (!snapshotFile.empty() || !restoreFile.empty() || !forks.empty()
+        || !profileFile.empty() || !callGraphFile.empty() || !traceFile.empty())) {
+        std::cerr << "-cores can't be used with snapshots, forks, profiling or tracing\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Emulator emulator;
+    emulator.setCores(static_cast<unsigned>(cores), roundRobin, quantum);
+    emulator.setBlockTranslation(blockTranslation);
+    emulator.setJit(jit);
+    emulator.setPerfMap(perfMap);
+    emulator.setVirtualTime(instructionsPerSecond);
+    if (!snapshotFile.empty()) emulator.setSnapshot(snapshotFile, snapshotTrigger, snapshotInstruction);
+    if (!forks.empty()) emulator.setForkPoint(snapshotTrigger, snapshotInstruction);
+    if (!profileFile.empty()) emulator.setProfile(profileFile);
+    if (!callGraphFile.empty()) emulator.setCallGraph(callGraphFile);
+    if (!traceFile.empty()) {
+        try {
+            emulator.setTrace(traceFile, traceEntries);
+        } catch (const std::bad_alloc&) {
+            std::cerr << "Cannot allocate a trace ring of " << traceEntries << " entries\n";
+            return 1;
+        }
+    }
+    emulator.setBudget(maxInstructions, timeout);
+
+    if (!mapFile.empty()) {
+        try {
+            emulator.setSymbolMap(mapFile);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error reading file " << mapFile << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        if (restoreFile.empty()) {
+            emulator.readFile(filename);
+        } else {
+            emulator.restoreSnapshot(restoreFile);
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error reading file " << (restoreFile.empty() ? filename : restoreFile) << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    if (headless) {
+        try {
+            emulator.setHeadless(inputFile, outputFile);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    try {
+        if (!emulator.emulate()) return 2;
+        if (emulator.budgetExhausted()) return 3;
+        if (forks.empty()) return 0;
+        if (!emulator.stoppedAtForkPoint()) {
+            std::cerr << "The processor halted before reaching the fork point, no copies were run\n";
+            return 0;
+        }
+        return runForks(emulator, forks);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Emulation error: " << e.what() << "\n";
+        return 2;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "imageReader.hpp"
+#include "executable.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+ImageReader::ImageReader(const std::string& filename){
+    parseFile(filename);
+}
+ImageReader::~ImageReader(){
+    if(mapping) munmap(mapping, mappingSize);
+}
+const std::vector<ImageReader::Segment>& ImageReader::getSegments() const{
+    return segments;
+}
+void ImageReader::parseFile(const std::string& filename){
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    uint8_t magic[sizeof(EXECUTABLE_MAGIC)];
+    in.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    bool segmented = in.gcount() == sizeof(magic)
+        && std::memcmp(magic, EXECUTABLE_MAGIC, sizeof(magic)) == 0;
+    in.close();
+
+    if (segmented) parseSegments(filename);
+    else parseLegacy(filename);
+}
+void ImageReader::parseSegments(const std::string& filename){
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error("Read error: " + filename);
+    }
+    mappingSize = st.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Read error: cannot map " + filename);
+    }
+    const uint8_t* file = static_cast<const uint8_t*>(mapping);
+
+    if (mappingSize < sizeof(ExecutableHeader)) {
+        throw std::runtime_error("Input error: truncated header in " + filename);
+    }
+    ExecutableHeader header;
+    std::memcpy(&header, file, sizeof(header));
+    uint64_t tableEnd = header.segmentTableOffset
+        + static_cast<uint64_t>(header.segmentCount) * sizeof(ExecutableSegment);
+    if (tableEnd > mappingSize) {
+        throw std::runtime_error("Input error: truncated segment table in " + filename);
+    }
+
+    for (uint32_t i = 0; i < header.segmentCount; ++i) {
+        ExecutableSegment entry;
+        std::memcpy(&entry, file + header.segmentTableOffset + i * sizeof(ExecutableSegment), sizeof(entry));
+        if (static_cast<uint64_t>(entry.offset) + entry.size > mappingSize) {
+            throw std::runtime_error("Input error: truncated segment contents in " + filename);
+        }
+        if (entry.size == 0) continue;
+        segments.push_back({entry.address, file + entry.offset, entry.size});
+    }
+    std::sort(segments.begin(), segments.end(),
+        [](const Segment& l, const Segment& r){ return l.address < r.address; });
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+        if (static_cast<uint64_t>(segments[i].address) + segments[i].size > 0x100000000ull
+            || (i > 0 && static_cast<uint64_t>(segments[i - 1].address) + segments[i - 1].size > segments[i].address)) {
+            std::ostringstream oss;
+            oss << "Input error: multiple values for address 0x"
+                << std::hex << std::setw(8) << std::setfill('0') << segments[i].address;
+            throw std::runtime_error(oss.str());
+        }
+    }
+}
+void ImageReader::parseLegacy(const std::string& filename){
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    //Every entry is a 4B address followed by a 1B value
+    std::vector<std::pair<uint32_t, uint8_t>> entries;
+    while (true) {
+        uint32_t address;
+        uint8_t value;
+
+        // Read 4B address
+        in.read(reinterpret_cast<char*>(&address), sizeof(address));
+        if (in.eof()) break;
+
+        // Read 1B value
+        in.read(reinterpret_cast<char*>(&value), sizeof(value));
+        if (in.eof()) break;
+
+        entries.emplace_back(address, value);
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const auto& l, const auto& r){ return l.first < r.first; });
+
+    //Merge consecutive addresses into segments
+    std::vector<uint32_t> addresses;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        uint32_t address = entries[i].first;
+        if (i > 0 && entries[i - 1].first == address) {
+            std::ostringstream oss;
+            oss << "Input error: multiple values for address 0x"
+                << std::hex << std::setw(8) << std::setfill('0') << address;
+            throw std::runtime_error(oss.str());
+        }
+        if (i == 0 || entries[i - 1].first + 1 != address) {
+            addresses.push_back(address);
+            legacyContents.emplace_back();
+        }
+        legacyContents.back().push_back(entries[i].second);
+    }
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        segments.push_back({addresses[i], legacyContents[i].data(), legacyContents[i].size()});
+    }
+}
@@ -54,6 +54,10 @@ std::vector<uint8_t> InstructionEncoder::iret(){
 
     return result;
 }
+std::vector<uint8_t> InstructionEncoder::wait(){
+    //A0 00 00 00
+    return makeInstruction(0xA,0x0,0x0,0x0,0x0,0x000);
+}
 std::vector<uint8_t> InstructionEncoder::call(int address){
     //21 <PC>0 00 04
     //30 <PC>0 00 04
@@ -187,6 +191,18 @@ std::vector<uint8_t> InstructionEncoder::shr(int gprS, int gprD){
     //71 <gprD><gprD> <gprS>0 00
     return makeInstruction(0x7, 0x1, gprD, gprD, gprS, 0x000);
 }
+std::vector<uint8_t> InstructionEncoder::copy(int gprS, int gprD, int gprN){
+    //B0 <gprD><gprS> <gprN>0 00
+    return makeInstruction(0xB, 0x0, gprD, gprS, gprN, 0x000);
+}
+std::vector<uint8_t> InstructionEncoder::fill(int gprS, int gprD, int gprN){
+    //B1 <gprD><gprS> <gprN>0 00
+    return makeInstruction(0xB, 0x1, gprD, gprS, gprN, 0x000);
+}
+std::vector<uint8_t> InstructionEncoder::packed(uint8_t operation, int gprS, int gprD){
+    //C<operation> <gprD><gprD> <gprS>0 00
+    return makeInstruction(0xC, operation, gprD, gprD, gprS, 0x000);
+}
 std::vector<uint8_t> InstructionEncoder::ld_immediate(int gpr, int imm) {
     //93 <gpr><PC> 00 04
     //<imm>
@@ -0,0 +1,580 @@
+#include "jitCompiler.hpp"
+#include "packedLanes.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace{
+using PackedOperation = uint32_t (*)(uint32_t, uint32_t);
+template<size_t... MODS>
+constexpr std::array<PackedOperation, sizeof...(MODS)> makePackedTable(std::index_sequence<MODS...>){
+    return {{ &PackedLanes::apply<static_cast<uint8_t>(MODS)>... }};
+}
+//Packed operations by modifier
+constexpr std::array<PackedOperation, PackedLanes::OPERATIONS> packedOperations =
+    makePackedTable(std::make_index_sequence<PackedLanes::OPERATIONS>{});
+
+template<typename Function>
+uint64_t address(Function function){
+    return reinterpret_cast<uint64_t>(function);
+}
+}
+
+JitCompiler::JitCompiler(Emulator& emulator) : emulator(emulator){
+}
+JitCompiler::~JitCompiler(){
+    if(buffer) munmap(buffer, BUFFER_SIZE);
+}
+bool JitCompiler::supported(){
+#if defined(__x86_64__) && defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+void JitCompiler::rethrow(){
+    if(!failed) return;
+    failed = false;
+    std::rethrow_exception(std::exchange(error, nullptr));
+}
+void JitCompiler::fail(){
+    failed = true;
+    error = std::current_exception();
+    emulator.blockExit = true;
+}
+
+uint32_t JitCompiler::readWord(Emulator* emulator, uint32_t address){
+    try{
+        return emulator->readWordMem(address);
+    }catch(...){
+        //Exceptions can't unwind through compiled code, the emulator throws it again once the code returned
+        emulator->jit->fail();
+        return 0;
+    }
+}
+void JitCompiler::writeWord(Emulator* emulator, uint32_t address, uint32_t value){
+    try{
+        emulator->writeWordMem(address, value);
+    }catch(...){
+        emulator->jit->fail();
+    }
+}
+void JitCompiler::execute(Emulator* emulator, const Emulator::DecodedInstruction* di){
+    try{
+        (emulator->*di->handler)(*di);
+    }catch(...){
+        emulator->jit->fail();
+    }
+}
+void JitCompiler::indirectMiss(Emulator* emulator, IndirectExit* exit, uint32_t pc){
+    auto target = emulator->blocks.find(pc);
+    exit->pc = pc;
+    exit->block = target != emulator->blocks.end() ? target->second.get() : nullptr;
+}
+
+JitCompiler::Code JitCompiler::compile(Emulator::TranslatedBlock& block){
+    code.clear();
+    leaveJumps.clear();
+    stubs.clear();
+    //Inline caches of the code compiled before; those of this block are added after them
+    size_t previousExits = indirectExits.size();
+    nativeOffset = static_cast<int32_t>(reinterpret_cast<const char*>(&block.native) - reinterpret_cast<const char*>(&block));
+    selectCachedRegisters(block);
+
+    //Prologue: push rbx, rbp, r12-r15; sub rsp, 8 (calls need the stack 16-byte aligned); mov rbx, rdi
+    for(uint8_t byte: {0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57, 0x48, 0x83, 0xEC, 0x08, 0x48, 0x89, 0xFB}){
+        emit8(byte);
+    }
+    //Blocks jumping here enter from this point on: runningBlock <= block
+    movRegImm64(RAX, address(&block));
+    rex(true, RAX, RBX);
+    emit8(0x89);
+    memoryOperand(RAX, memberOffset(&emulator.runningBlock));
+    //cmp dword [pageGeneration], generation: a stale block goes back to the emulator, with PC at its start.
+    //Another core may move a shared generation on; an aligned load sees it whole, and is an acquire on x86
+    movRegImm64(RAX, address(block.pageGeneration));
+    emit8(0x81);
+    emit8(0x38);
+    emit32(block.generation);
+    jumpLeave(NOT_EQUAL);
+    reloadRegisters();
+
+    uint32_t count = 0;
+    for(size_t i = 0; i < block.instructions.size(); i++){
+        const auto& instruction = block.instructions[i];
+        count += instruction.decoded.count;
+        bool last = i + 1 == block.instructions.size();
+        if(compileInstruction(instruction, count, last)) continue;
+        //Through the handler, which sets PC itself
+        movRegImm64(RSI, address(&instruction.decoded));
+        callOut(address(&execute), instruction.nextPc, count, false);
+        reloadRegisters();
+        if(last){
+            addCount(count);
+            jumpLeave();
+        }
+    }
+
+    for(const auto& stub: stubs){
+        bind(stub.jump, code.size());
+        //A call that threw leaves everything as it was when it failed
+        movRegImm64(RAX, address(&failed));
+        emit8(0x80);
+        emit8(0x38);
+        emit8(0x00);
+        jumpLeave(NOT_EQUAL);
+        if(stub.setPc) movMemImm(gprOffset(Emulator::PC), stub.pc);
+        addCount(stub.count);
+        jumpLeave();
+    }
+    //Epilogue: add rsp, 8; pop r15-r12, rbp, rbx; ret
+    for(size_t leave: leaveJumps) bind(leave, code.size());
+    for(uint8_t byte: {0x48, 0x83, 0xC4, 0x08, 0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B, 0xC3}){
+        emit8(byte);
+    }
+
+    if(!buffer){
+        void* mapped = mmap(nullptr, BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(mapped == MAP_FAILED) return nullptr;
+        buffer = static_cast<uint8_t*>(mapped);
+    }
+    size_t start = (used + 15) & ~size_t(15);
+    if(start + code.size() > BUFFER_SIZE){
+        //Full: drop all code compiled so far, blocks get compiled again as they run
+        for(auto& entry: emulator.blocks) entry.second->native = nullptr;
+        //Nothing refers to their inline caches any more; erasing at the front keeps this block's ones in place
+        indirectExits.erase(indirectExits.begin(), indirectExits.begin() + previousExits);
+        start = 0;
+    }
+    //Never writable and executable at once
+    if(mprotect(buffer, BUFFER_SIZE, PROT_READ | PROT_WRITE) != 0) return nullptr;
+    std::memcpy(buffer + start, code.data(), code.size());
+    if(mprotect(buffer, BUFFER_SIZE, PROT_READ | PROT_EXEC) != 0) return nullptr;
+    used = start + code.size();
+    if(perfMap) describe(buffer + start, code.size(), block.start);
+    return reinterpret_cast<Code>(buffer + start);
+}
+
+void JitCompiler::describe(const uint8_t* start, size_t size, uint32_t blockStart){
+    //Shared by the JIT compilers of all cores
+    static std::mutex mapLock;
+    std::lock_guard<std::mutex> lock(mapLock);
+    std::ofstream map("/tmp/perf-" + std::to_string(getpid()) + ".map", std::ios::app);
+    std::string name;
+    if(emulator.symbolMap){
+        name = emulator.symbolMap->describe(blockStart);
+    }else{
+        std::ostringstream oss;
+        oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << blockStart;
+        name = oss.str();
+    }
+    map << std::hex << reinterpret_cast<uintptr_t>(start) << " " << size << " emulated:" << name << "\n";
+}
+
+void JitCompiler::selectCachedRegisters(const Emulator::TranslatedBlock& block){
+    //The registers the block names most often (PC is known while compiling, r0 reads as 0)
+    uint32_t uses[17] = {};
+    for(const auto& instruction: block.instructions){
+        for(uint8_t index: {instruction.decoded.a, instruction.decoded.b, instruction.decoded.c}){
+            if(index != 0 && index != Emulator::PC) uses[index]++;
+        }
+    }
+    std::fill(std::begin(cached), std::end(cached), 0);
+    dirty = 0;
+    for(Register host: CACHE_REGISTERS){
+        uint8_t best = 0;
+        for(uint8_t index = 1; index < Emulator::PC; index++){
+            if(!cached[index] && uses[index] > uses[best]) best = index;
+        }
+        //Loading and saving a register once used only once doesn't pay off
+        if(uses[best] < 2) break;
+        cached[best] = host;
+    }
+}
+
+bool JitCompiler::compileInstruction(const Emulator::BlockInstruction& instruction, uint32_t count, bool last){
+    const Emulator::DecodedInstruction& di = instruction.decoded;
+    uint32_t nextPc = instruction.nextPc;
+    //PC once the instruction is done, unless it jumps
+    uint32_t pcAfter = nextPc - 4 + di.length;
+    uint8_t byte0 = di.word & 0xFF;
+    uint8_t oc = byte0 >> 4;
+    uint8_t mod = byte0 & 0x0F;
+    if(Emulator::hasIllegalFields(oc, mod, di) || di.handler == &Emulator::executeIdleLoop) return false;
+
+    if(di.length == 8 && byte0 == 0x93){
+        //ld $imm
+        movRegImm(RAX, di.literal);
+        storeRegister(di.ad, RAX);
+    }else if(di.length == 12 && byte0 == 0x93){
+        //ld mem
+        movRegImm(RAX, di.literal);
+        storeRegister(di.ad, RAX);
+        movRegImm(RSI, di.literal);
+        callOut(address(&readWord), nextPc, count, true, pcAfter);
+        storeRegister(di.ad, RAX);
+    }else if(di.length == 12 && byte0 == 0x82){
+        //st to a literal address
+        movRegImm(RSI, di.literal);
+        loadRegister(RDX, di.c, nextPc);
+        callOut(address(&writeWord), nextPc, count, true, pcAfter);
+    }else if(di.length == 8 && byte0 == 0x38){
+        //jmp
+        exitBlock(di.literal, count, true);
+        return true;
+    }else if(di.length == 12 && byte0 == 0x21){
+        //call: push pc; pc <= literal
+        loadRegister(RAX, Emulator::SP, nextPc);
+        addRegImm(RAX, -4);
+        storeRegister(Emulator::SP, RAX);
+        movRegReg(RSI, RAX);
+        movRegImm(RDX, nextPc);
+        callOut(address(&writeWord), nextPc, count, true, di.literal);
+        exitBlock(di.literal, count, true);
+        return true;
+    }else if(di.length == 12 && byte0 >= 0x39 && byte0 <= 0x3B){
+        //beq, bne, bgt: cmp eax, ecx; jcc taken
+        loadRegister(RAX, di.b, nextPc);
+        loadRegister(RCX, di.c, nextPc);
+        flushRegisters();
+        emit8(0x39);
+        emit8(0xC8);
+        size_t taken = jump(byte0 == 0x39 ? EQUAL : byte0 == 0x3A ? NOT_EQUAL : GREATER);
+        //Not taken: the jump over the literal retires too
+        exitBlock(nextPc + 8, count + 1, true);
+        bind(taken, code.size());
+        exitBlock(di.literal, count, true);
+        return true;
+    }else if(di.length != 4){
+        return false;
+    }else if(byte0 == 0x30){
+        //jmp: pc<=gpr[A]+D
+        if(di.a == Emulator::PC || di.a == 0){
+            exitBlock((di.a == Emulator::PC ? nextPc : 0) + di.disp, count, true);
+        }else{
+            loadRegister(RCX, di.a, nextPc);
+            if(di.disp) addRegImm(RCX, di.disp);
+            exitIndirect(count);
+        }
+        return true;
+    }else if(byte0 >= 0x31 && byte0 <= 0x33 && (di.a == Emulator::PC || di.a == 0)){
+        //beq, bne, bgt to a target known while compiling
+        loadRegister(RAX, di.b, nextPc);
+        loadRegister(RCX, di.c, nextPc);
+        flushRegisters();
+        emit8(0x39);
+        emit8(0xC8);
+        size_t taken = jump(byte0 == 0x31 ? EQUAL : byte0 == 0x32 ? NOT_EQUAL : GREATER);
+        exitBlock(nextPc, count, true);
+        bind(taken, code.size());
+        exitBlock((di.a == Emulator::PC ? nextPc : 0) + di.disp, count, true);
+        return true;
+    }else if(byte0 == 0x93 && di.a == Emulator::PC && di.b != Emulator::PC && di.bd != Emulator::PC){
+        //pop pc (ret): to wherever the stack says
+        loadRegister(RSI, di.b, nextPc);
+        callOut(address(&readWord), nextPc, count, true, pcAfter);
+        movRegReg(RCX, RAX);
+        loadRegister(RAX, di.b, nextPc);
+        if(di.disp) addRegImm(RAX, di.disp);
+        storeRegister(di.bd, RAX);
+        exitIndirect(count);
+        return true;
+    }else if(byte0 == 0x40){
+        //xchg
+        if(di.bd == Emulator::PC || di.cd == Emulator::PC) return false;
+        loadRegister(RAX, di.b, nextPc);
+        loadRegister(RCX, di.c, nextPc);
+        storeRegister(di.bd, RCX);
+        storeRegister(di.cd, RAX);
+    }else if((oc == 0x5 && mod <= 2) || (oc == 0x6 && mod <= 3) || (oc == 0x7 && mod <= 1)){
+        //Register arithmetic (but division, which may raise an interrupt), logic and shifts
+        if(di.ad == Emulator::PC) return false;
+        loadRegister(RAX, di.b, nextPc);
+        loadRegister(RCX, di.c, nextPc);
+        switch(byte0){
+            case 0x50: aluRegReg(0x01, RAX, RCX); break;
+            case 0x51: aluRegReg(0x29, RAX, RCX); break;
+            //imul eax, ecx
+            case 0x52: emit8(0x0F); emit8(0xAF); emit8(0xC1); break;
+            //not eax
+            case 0x60: emit8(0xF7); emit8(0xD0); break;
+            case 0x61: aluRegReg(0x21, RAX, RCX); break;
+            case 0x62: aluRegReg(0x09, RAX, RCX); break;
+            case 0x63: aluRegReg(0x31, RAX, RCX); break;
+            //shl eax, cl; sar eax, cl (the count taken modulo 32, as by the handlers on this host)
+            case 0x70: emit8(0xD3); emit8(0xE0); break;
+            case 0x71: emit8(0xD3); emit8(0xF8); break;
+        }
+        storeRegister(di.ad, RAX);
+    }else if(oc == 0xC && mod < PackedLanes::OPERATIONS){
+        if(di.ad == Emulator::PC) return false;
+        loadRegister(RDI, di.b, nextPc);
+        loadRegister(RSI, di.c, nextPc);
+        callAbsolute(address(packedOperations[mod]));
+        storeRegister(di.ad, RAX);
+    }else if(byte0 == 0x91){
+        //gpr[A]<=gpr[B]+D
+        if(di.ad == Emulator::PC) return false;
+        loadRegister(RAX, di.b, nextPc);
+        if(di.disp) addRegImm(RAX, di.disp);
+        storeRegister(di.ad, RAX);
+    }else if(byte0 == 0x92){
+        //gpr[A]<=mem32[gpr[B]+gpr[C]+D]
+        if(di.ad == Emulator::PC) return false;
+        loadRegister(RSI, di.b, nextPc);
+        loadRegister(RCX, di.c, nextPc);
+        aluRegReg(0x01, RSI, RCX);
+        if(di.disp) addRegImm(RSI, di.disp);
+        callOut(address(&readWord), nextPc, count, true, pcAfter);
+        storeRegister(di.ad, RAX);
+    }else if(byte0 == 0x93){
+        //gpr[A]<=mem32[gpr[B]]; gpr[B]<=gpr[B]+D (reading B again, in case it was A)
+        if(di.ad == Emulator::PC || di.bd == Emulator::PC) return false;
+        loadRegister(RSI, di.b, nextPc);
+        callOut(address(&readWord), nextPc, count, true, pcAfter);
+        storeRegister(di.ad, RAX);
+        loadRegister(RAX, di.b, nextPc);
+        if(di.disp) addRegImm(RAX, di.disp);
+        storeRegister(di.bd, RAX);
+    }else if(byte0 == 0x80){
+        //mem32[gpr[A]+gpr[B]+D]<=gpr[C]
+        loadRegister(RSI, di.a, nextPc);
+        loadRegister(RCX, di.b, nextPc);
+        aluRegReg(0x01, RSI, RCX);
+        if(di.disp) addRegImm(RSI, di.disp);
+        loadRegister(RDX, di.c, nextPc);
+        callOut(address(&writeWord), nextPc, count, true, pcAfter);
+    }else if(byte0 == 0x81){
+        //gpr[A]<=gpr[A]+D; mem32[gpr[A]]<=gpr[C]
+        if(di.ad == Emulator::PC) return false;
+        loadRegister(RAX, di.a, nextPc);
+        if(di.disp) addRegImm(RAX, di.disp);
+        storeRegister(di.ad, RAX);
+        loadRegister(RSI, di.a, nextPc);
+        loadRegister(RDX, di.c, nextPc);
+        callOut(address(&writeWord), nextPc, count, true, pcAfter);
+    }else{
+        return false;
+    }
+    //The block ends here without a jump: it goes on at the next instruction
+    if(last) exitBlock(pcAfter, count, true);
+    return true;
+}
+
+void JitCompiler::callOut(uint64_t function, uint32_t nextPc, uint32_t count, bool setPc, uint32_t pcAfter){
+    //The callee may look at PC (performance counters) and at any register (failures print them all)
+    movMemImm(gprOffset(Emulator::PC), nextPc);
+    flushRegisters();
+    //mov rdi, rbx
+    emit8(0x48);
+    emit8(0x89);
+    emit8(0xDF);
+    callAbsolute(function);
+    //cmp byte [blockExit], 0; jne stub
+    emit8(0x80);
+    memoryOperand(7, memberOffset(&emulator.blockExit));
+    emit8(0x00);
+    stubs.push_back({jump(NOT_EQUAL), setPc, pcAfter, count});
+}
+
+void JitCompiler::exitBlock(uint32_t pc, uint32_t count, bool chain){
+    flushRegisters();
+    movMemImm(gprOffset(Emulator::PC), pc);
+    addCount(count);
+    auto target = emulator.blocks.find(pc);
+    if(chain && target != emulator.blocks.end()){
+        checkContinue();
+        //The next block's code as it is when we get there (compiled later, or dropped):
+        //mov rax, [native]; test rax, rax; je leave; add rax, PROLOGUE_SIZE; jmp rax
+        movRegImm64(RAX, address(&target->second->native));
+        for(uint8_t byte: {0x48, 0x8B, 0x00, 0x48, 0x85, 0xC0}) emit8(byte);
+        jumpLeave(EQUAL);
+        for(uint8_t byte: {0x48, 0x83, 0xC0}) emit8(byte);
+        emit8(PROLOGUE_SIZE);
+        emit8(0xFF);
+        emit8(0xE0);
+        return;
+    }
+    jumpLeave();
+}
+void JitCompiler::exitIndirect(uint32_t count){
+    flushRegisters();
+    movMemReg(gprOffset(Emulator::PC), RCX);
+    addCount(count);
+    checkContinue();
+    indirectExits.emplace_back();
+    //mov rdx, exit; cmp ecx, [rdx]; jne miss
+    movRegImm64(RDX, address(&indirectExits.back()));
+    emit8(0x3B);
+    emit8(0x0A);
+    size_t miss = jump(NOT_EQUAL);
+    //mov rax, [rdx + 8]; test rax, rax; je leave
+    for(uint8_t byte: {0x48, 0x8B, 0x42, 0x08, 0x48, 0x85, 0xC0}) emit8(byte);
+    jumpLeave(EQUAL);
+    //mov rax, [rax + nativeOffset]; test rax, rax; je leave; add rax, PROLOGUE_SIZE; jmp rax
+    for(uint8_t byte: {0x48, 0x8B, 0x80}) emit8(byte);
+    emit32(static_cast<uint32_t>(nativeOffset));
+    for(uint8_t byte: {0x48, 0x85, 0xC0}) emit8(byte);
+    jumpLeave(EQUAL);
+    for(uint8_t byte: {0x48, 0x83, 0xC0}) emit8(byte);
+    emit8(PROLOGUE_SIZE);
+    emit8(0xFF);
+    emit8(0xE0);
+    //miss: mov rdi, rbx; mov rsi, rdx; mov edx, ecx; call indirectMiss; and return
+    bind(miss, code.size());
+    for(uint8_t byte: {0x48, 0x89, 0xDF, 0x48, 0x89, 0xD6, 0x89, 0xCA}) emit8(byte);
+    callAbsolute(address(&indirectMiss));
+    jumpLeave();
+}
+void JitCompiler::checkContinue(){
+    //Go on without returning only where handleInterrupts() would do nothing:
+    //mov rax, [instructionCount]; cmp rax, [nextDeadline]; jae leave
+    rex(true, RAX, RBX);
+    emit8(0x8B);
+    memoryOperand(RAX, memberOffset(&emulator.instructionCount));
+    rex(true, RAX, RBX);
+    emit8(0x3B);
+    memoryOperand(RAX, memberOffset(&emulator.nextDeadline));
+    jumpLeave(ABOVE_OR_EQUAL);
+    //cmp dword [pendingInterrupts], 0; jne leave
+    emit8(0x83);
+    memoryOperand(7, memberOffset(&emulator.pendingInterrupts));
+    emit8(0x00);
+    jumpLeave(NOT_EQUAL);
+    //cmp byte [emulatorRunning], 0; je leave
+    emit8(0x80);
+    memoryOperand(7, memberOffset(&emulator.emulatorRunning));
+    emit8(0x00);
+    jumpLeave(EQUAL);
+}
+
+void JitCompiler::loadRegister(Register destination, uint8_t index, uint32_t nextPc){
+    if(index == Emulator::PC){
+        movRegImm(destination, nextPc);
+    }else if(index == 0){
+        movRegImm(destination, 0);
+    }else if(cached[index]){
+        movRegReg(destination, static_cast<Register>(cached[index]));
+    }else{
+        movRegMem(destination, gprOffset(index));
+    }
+}
+void JitCompiler::storeRegister(uint8_t index, Register source){
+    if(cached[index]){
+        movRegReg(static_cast<Register>(cached[index]), source);
+        dirty |= 1u << index;
+    }else{
+        movMemReg(gprOffset(index), source);
+    }
+}
+void JitCompiler::flushRegisters(){
+    for(uint8_t index = 0; index < 17; index++){
+        if(dirty & (1u << index)) movMemReg(gprOffset(index), static_cast<Register>(cached[index]));
+    }
+    dirty = 0;
+}
+void JitCompiler::reloadRegisters(){
+    for(uint8_t index = 0; index < 17; index++){
+        if(cached[index]) movRegMem(static_cast<Register>(cached[index]), gprOffset(index));
+    }
+    dirty = 0;
+}
+
+int32_t JitCompiler::gprOffset(uint8_t index) const{
+    return memberOffset(&emulator.gpr[index]);
+}
+int32_t JitCompiler::memberOffset(const void* member) const{
+    return static_cast<int32_t>(static_cast<const char*>(member) - reinterpret_cast<const char*>(&emulator));
+}
+
+void JitCompiler::emit32(uint32_t value){
+    for(int i = 0; i < 4; i++) emit8(static_cast<uint8_t>(value >> (8 * i)));
+}
+void JitCompiler::emit64(uint64_t value){
+    emit32(static_cast<uint32_t>(value));
+    emit32(static_cast<uint32_t>(value >> 32));
+}
+void JitCompiler::rex(bool wide, uint8_t reg, uint8_t rm){
+    uint8_t prefix = 0x40 | (wide ? 0x8 : 0) | ((reg & 0x8) ? 0x4 : 0) | ((rm & 0x8) ? 0x1 : 0);
+    if(prefix != 0x40) emit8(prefix);
+}
+void JitCompiler::memoryOperand(uint8_t reg, int32_t offset){
+    //mod 10 (disp32), rm rbx
+    emit8(0x80 | (reg & 0x7) << 3 | RBX);
+    emit32(static_cast<uint32_t>(offset));
+}
+void JitCompiler::movRegReg(Register destination, Register source){
+    aluRegReg(0x89, destination, source);
+}
+void JitCompiler::movRegImm(Register destination, uint32_t value){
+    rex(false, 0, destination);
+    emit8(0xB8 + (destination & 0x7));
+    emit32(value);
+}
+void JitCompiler::movRegImm64(Register destination, uint64_t value){
+    rex(true, 0, destination);
+    emit8(0xB8 + (destination & 0x7));
+    emit64(value);
+}
+void JitCompiler::movRegMem(Register destination, int32_t offset){
+    rex(false, destination, RBX);
+    emit8(0x8B);
+    memoryOperand(destination, offset);
+}
+void JitCompiler::movMemReg(int32_t offset, Register source){
+    rex(false, source, RBX);
+    emit8(0x89);
+    memoryOperand(source, offset);
+}
+void JitCompiler::movMemImm(int32_t offset, uint32_t value){
+    emit8(0xC7);
+    memoryOperand(0, offset);
+    emit32(value);
+}
+void JitCompiler::aluRegReg(uint8_t opcode, Register destination, Register source){
+    rex(false, source, destination);
+    emit8(opcode);
+    emit8(0xC0 | (source & 0x7) << 3 | (destination & 0x7));
+}
+void JitCompiler::addRegImm(Register destination, int32_t value){
+    rex(false, 0, destination);
+    emit8(0x81);
+    emit8(0xC0 | (destination & 0x7));
+    emit32(static_cast<uint32_t>(value));
+}
+void JitCompiler::addCount(uint32_t count){
+    //add qword [instructionCount], count
+    rex(true, 0, RBX);
+    emit8(0x81);
+    memoryOperand(0, memberOffset(&emulator.instructionCount));
+    emit32(count);
+}
+void JitCompiler::callAbsolute(uint64_t function){
+    //mov rax, function; call rax
+    movRegImm64(RAX, function);
+    emit8(0xFF);
+    emit8(0xD0);
+}
+size_t JitCompiler::jump(){
+    emit8(0xE9);
+    emit32(0);
+    return code.size() - 4;
+}
+size_t JitCompiler::jump(Condition condition){
+    emit8(0x0F);
+    emit8(0x80 | condition);
+    emit32(0);
+    return code.size() - 4;
+}
+void JitCompiler::bind(size_t jump, size_t target){
+    uint32_t relative = static_cast<uint32_t>(target - (jump + 4));
+    std::memcpy(&code[jump], &relative, 4);
+}
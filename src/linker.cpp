@@ -6,6 +6,8 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
+#include <tuple>
 #include "shelfReader.hpp"
 #include "shelf.hpp"
 #include "section.hpp"
@@ -13,6 +15,8 @@
 #include "relocation.hpp"
 #include "shelfWriter.hpp"
 #include "shelfPrinter.hpp"
+#include "executable.hpp"
+#include "imageReader.hpp"
 void Linker::readFile(const std::string& filename){
     ShelfReader reader(filename);
     //Add sections
@@ -65,23 +69,49 @@ void Linker::link(const std::string& outputFilename){
     assignFinalSectionAddresses();
     applyRelocations();
 
-    std::ofstream out(outputFilename, std::ios::binary);
-    if(!out) throw std::runtime_error("Cannot open output file");
-
+    //Gather the placed sections by address; sections that touch end up in the same segment
+    std::vector<size_t> placed;
     for (size_t i = 0; i < sectionHeaders.size(); ++i) {
+        if(sectionHeaders[i].type != SHELF_PROGBITS || sectionContents[i].empty()) continue;
+        placed.push_back(i);
+    }
+    std::sort(placed.begin(), placed.end(), [this](size_t l, size_t r){
+        return sectionHeaders[l].address < sectionHeaders[r].address;
+    });
+    std::vector<ExecutableSegment> segments;
+    std::vector<std::vector<uint8_t>> segmentContents;
+    for (size_t i: placed) {
         const auto& sh = sectionHeaders[i];
-        if(sh.type != SHELF_PROGBITS) continue;
-
         const auto& content = sectionContents[i];
-        uint32_t baseAddr = sh.address;
+        if (segments.empty() || static_cast<uint64_t>(segments.back().address) + segments.back().size != sh.address) {
+            segments.push_back({sh.address, 0, 0});
+            segmentContents.emplace_back();
+        }
+        segmentContents.back().insert(segmentContents.back().end(), content.begin(), content.end());
+        segments.back().size += content.size();
+    }
 
-        for (size_t j = 0; j < content.size(); ++j) {
-            uint32_t addr = baseAddr + j;
-            uint8_t value = content[j];
+    //Header and segment table, then every segment at the next aligned offset
+    ExecutableHeader header;
+    std::copy(std::begin(EXECUTABLE_MAGIC), std::end(EXECUTABLE_MAGIC), header.magic);
+    header.segmentCount = segments.size();
+    header.segmentTableOffset = sizeof(ExecutableHeader);
+    uint32_t offset = header.segmentTableOffset + segments.size() * sizeof(ExecutableSegment);
+    for (auto& segment: segments) {
+        offset = (offset + EXECUTABLE_ALIGNMENT - 1) & ~(EXECUTABLE_ALIGNMENT - 1);
+        segment.offset = offset;
+        offset += segment.size;
+    }
 
-            out.write(reinterpret_cast<const char*>(&addr), sizeof(addr));
-            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
-        }
+    std::ofstream out(outputFilename, std::ios::binary);
+    if(!out) throw std::runtime_error("Cannot open output file");
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(segments.data()), segments.size() * sizeof(ExecutableSegment));
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::vector<char> padding(segments[i].offset - out.tellp(), 0);
+        out.write(padding.data(), padding.size());
+        out.write(reinterpret_cast<const char*>(segmentContents[i].data()), segmentContents[i].size());
     }
 
     out.close();
@@ -322,11 +352,7 @@ void Linker::debugPrintState() const {
     std::cout << "===================\n";
 }
 void Linker::printLinkedFile(const std::string& filename) const {
-    std::ifstream in(filename, std::ios::binary);
-    if (!in) {
-        std::cerr << "Cannot open file: " << filename << "\n";
-        return;
-    }
+    ImageReader image(filename);
     std::string outFilename = filename + ".txt";
     std::ofstream out(outFilename);
     if (!out) {
@@ -334,55 +360,64 @@ void Linker::printLinkedFile(const std::string& filename) const {
         return;
     }
 
-    std::map<uint32_t, uint8_t> memory;
-
-    while (true) {
-        uint32_t address;
-        uint8_t value;
-
-        //Read 4B address
-        in.read(reinterpret_cast<char*>(&address), sizeof(address));
-        if (in.eof()) break;
-
-        //Read 1B value
-        in.read(reinterpret_cast<char*>(&value), sizeof(value));
-        if (in.eof()) break;
-
-        memory[address] = value;
-    }
-
     uint32_t countInLine = 0;
-    uint32_t prevAddress = 0;
     bool first = true;
 
-    for (auto it = memory.begin(); it != memory.end(); ++it) {
-        uint32_t addr = it->first;
+    for (const auto& segment: image.getSegments()) {
+        //There is a gap
+        if (!first) out << "\n...\n";
+        countInLine = 0;
 
-        if (!first) {
-            if (addr != prevAddress + 1) {
-                //There is a gap
-                out << "\n...\n";
-                countInLine = 0;
-            } else if (countInLine >= 8) {
+        for (size_t i = 0; i < segment.size; ++i) {
+            if (countInLine >= 8) {
                 out << "\n";
                 countInLine = 0;
             }
-        }
 
-        //Start a new line if this is the first byte of a line
-        if (countInLine == 0) {
-            out << std::hex << std::setw(8) << std::setfill('0') << addr << ": ";
-        }
+            //Start a new line if this is the first byte of a line
+            if (countInLine == 0) {
+                out << std::hex << std::setw(8) << std::setfill('0') << segment.address + i << ": ";
+            }
 
-        out << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(it->second) << " ";
-        prevAddress = addr;
-        ++countInLine;
+            out << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(segment.bytes[i]) << " ";
+            ++countInLine;
+        }
         first = false;
     }
 
     if (!first) out << "\n";
 }
 
+void Linker::writeSymbolMap(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) {
+        throw std::runtime_error("Cannot open output file: " + filename);
+    }
+    out << std::hex << std::setfill('0');
+
+    std::vector<std::pair<uint32_t, std::string>> sections;
+    for (const auto& [name, address] : mergedSectionAddresses) {
+        sections.emplace_back(address, name);
+    }
+    std::sort(sections.begin(), sections.end());
+    for (const auto& [address, name] : sections) {
+        out << "section " << std::setw(8) << address << " " << std::setw(8) << mergedSectionSizes.at(name) << " " << name << "\n";
+    }
+
+    //Resolved globals are copies of their definitions, so each of them is listed once
+    std::set<std::tuple<uint32_t, std::string, std::string>> entries;
+    for (const auto& sym : symbols) {
+        if (sym.name.empty() || sym.type == ST_SECTION) continue;
+        if (sym.sectionIndex == SHELF_SHN_ABS || sym.sectionIndex == SHELF_SHN_UNDEF) continue;
+        const auto& sh = sectionHeaders[sym.sectionIndex];
+        if (sh.type != SHELF_PROGBITS) continue;
+        entries.emplace(sh.address + sym.value, sh.name, sym.name);
+    }
+    for (const auto& [address, section, name] : entries) {
+        out << "symbol  " << std::setw(8) << address << " " << section << " " << name << "\n";
+    }
+}
+
 void Linker::linkRelocatable(const std::string& filename){
     generateWriterSections();
     checkDuplicateGlobals();
@@ -571,7 +606,8 @@ void printUsage(const char* progName) {
     std::cout << "  -o <file>            Specify output file.\n";
     std::cout << "  -hex                 Generate final hex output - input to the emulator.\n";
     std::cout << "  -relocatable         Generate relocatable output, which can be used as an input file for the linker.\n";
-    std::cout << "  -place=SECTION@ADDR  Specify start address for a section.\n\n";
+    std::cout << "  -place=SECTION@ADDR  Specify start address for a section.\n";
+    std::cout << "  -map=FILE            Also write the addresses of sections and symbols into FILE (only with -hex).\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << progName << " file1.o file2.o -o program.hex -hex -place=text@0x40000000 -place=data@0\n";
     std::cout << "  " << progName << " file1.o file2.o -o program.o -relocatable\n";
@@ -586,6 +622,7 @@ void printUsage(const char* progName) {
 int main(int argc, char** argv){
     Linker linker;
     std::string outputFile;
+    std::string mapFile;
     bool hexMode = false;
     bool relocatableMode = false;
 
@@ -616,6 +653,8 @@ int main(int argc, char** argv){
                 return 1;
             }
             outputFile = argv[++i];
+        } else if (arg.rfind("-map=", 0) == 0) {
+            mapFile = arg.substr(5);
         } else if (arg.rfind("-place=", 0) == 0) {
             std::string opt = arg.substr(7);
             auto atPos = opt.find('@');
@@ -650,6 +689,12 @@ int main(int argc, char** argv){
         return 1;
     }
 
+    if (!mapFile.empty() && !hexMode) {
+        std::cerr << "Cannot specify -map without -hex\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
     for (const auto& obj : objectFiles) {
         try {
             linker.readFile(obj);
@@ -662,6 +707,7 @@ int main(int argc, char** argv){
     if (hexMode) {
         try {
             linker.link(outputFile);
+            if (!mapFile.empty()) linker.writeSymbolMap(mapFile);
         } catch (const std::runtime_error& e) {
             std::cerr << "Linking error: " << e.what() << "\n";
             return 1;
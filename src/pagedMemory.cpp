@@ -0,0 +1,105 @@
+#include "pagedMemory.hpp"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+PagedMemory::PagedMemory(const PagedMemory& other) : allocatedPages(other.allocatedPages){
+    //Threads using the original would decide on use_count() while this copy changes it
+    if(other.allocationLock) throw std::logic_error("A shared memory can't be copied");
+    for(uint32_t i = 0; i < TABLE_SIZE; i++){
+        if(!other.tables[i]) continue;
+        tables[i] = std::make_unique<PageTable>(*other.tables[i]);
+        directory[i].store(tables[i].get(), std::memory_order_relaxed);
+    }
+}
+uint8_t* PagedMemory::allocatePage(uint32_t address){
+    std::unique_lock<std::mutex> lock;
+    if(allocationLock) lock = std::unique_lock<std::mutex>(*allocationLock);
+    uint32_t index = address >> (PAGE_BITS + TABLE_BITS);
+    auto& table = tables[index];
+    if(!table){
+        table = std::make_unique<PageTable>();
+        directory[index].store(table.get(), std::memory_order_release);
+    }
+    auto& slot = (*table)[(address >> PAGE_BITS) & TABLE_MASK];
+    if(!slot.owner){
+        //Value-initialization zero-fills the page
+        slot.owner = std::make_shared<Page>();
+        allocatedPages++;
+    }else if(slot.owner.use_count() != 1){
+        //Whoever else holds the page keeps the original
+        slot.owner = std::make_shared<Page>(*slot.owner);
+    }else{
+        return slot.owner->bytes;
+    }
+    slot.page.store(slot.owner.get(), std::memory_order_release);
+    return slot.owner->bytes;
+}
+
+uint32_t PagedMemory::readWordSlow(uint32_t address) const{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(readByte(address + i)) << (8 * i);
+    }
+    return value;
+}
+
+void PagedMemory::writeWordSlow(uint32_t address, uint32_t value){
+    for (uint32_t i = 0; i < 4; ++i) {
+        writeByte(address + i, static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void PagedMemory::writeBytes(uint32_t address, const uint8_t* data, size_t length){
+    while (length > 0) {
+        uint32_t offset = address & PAGE_MASK;
+        size_t chunk = std::min<size_t>(length, PAGE_SIZE - offset);
+        std::memcpy(getPage(address) + offset, data, chunk);
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void PagedMemory::copyBytes(uint32_t destination, uint32_t source, size_t length){
+    //A destination that overlaps the end of the source is copied from the end, so nothing is overwritten before it is read
+    bool backwards = destination > source && destination - source < length;
+    while (length > 0) {
+        uint32_t from;
+        uint32_t to;
+        size_t chunk;
+        if (!backwards) {
+            chunk = std::min<size_t>({length, PAGE_SIZE - (source & PAGE_MASK), PAGE_SIZE - (destination & PAGE_MASK)});
+            from = source;
+            to = destination;
+            source += chunk;
+            destination += chunk;
+        } else {
+            uint32_t sourceEnd = source + length;
+            uint32_t destinationEnd = destination + length;
+            chunk = std::min<size_t>({length, ((sourceEnd - 1) & PAGE_MASK) + 1, ((destinationEnd - 1) & PAGE_MASK) + 1});
+            from = sourceEnd - chunk;
+            to = destinationEnd - chunk;
+        }
+        length -= chunk;
+        //Pages never written read as zeros
+        const uint8_t* sourcePage = findPage(from);
+        if (!sourcePage && !findPage(to)) continue;
+        uint8_t* target = getPage(to) + (to & PAGE_MASK);
+        //Looked up again, in case it was the same page and getPage() replaced it with a private copy
+        sourcePage = findPage(from);
+        if (sourcePage) std::memmove(target, sourcePage + (from & PAGE_MASK), chunk);
+        else std::memset(target, 0, chunk);
+    }
+}
+
+void PagedMemory::fillBytes(uint32_t address, uint8_t value, size_t length){
+    while (length > 0) {
+        uint32_t offset = address & PAGE_MASK;
+        size_t chunk = std::min<size_t>(length, PAGE_SIZE - offset);
+        //Zeros needn't go into pages that were never written
+        if (value != 0 || findPage(address)) std::memset(getPage(address) + offset, value, chunk);
+        address += chunk;
+        length -= chunk;
+    }
+}
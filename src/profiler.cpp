@@ -0,0 +1,127 @@
+#include "profiler.hpp"
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+Profiler::Counters& Profiler::counters(uint32_t page){
+    lastPage = page;
+    auto& counters = pages[page];
+    if(!counters) counters = std::make_unique<Counters>();
+    return *counters;
+}
+
+void Profiler::enter(uint64_t frame){
+    auto it = nodes[current].children.find(frame);
+    if(it != nodes[current].children.end()){
+        current = it->second;
+        return;
+    }
+    uint32_t node = nodes.size();
+    nodes[current].children.emplace(frame, node);
+    nodes.push_back(Node{frame, current, 0, {}});
+    current = node;
+}
+
+namespace {
+    const char* causeName(uint32_t cause){
+        switch(cause){
+            case 1: return "illegal instruction";
+            case 2: return "timer";
+            case 3: return "terminal";
+            case 4: return "software";
+            case 6: return "terminal output";
+            default: return nullptr;
+        }
+    }
+    double share(uint64_t count, uint64_t total){
+        return total ? 100.0 * count / total : 0.0;
+    }
+    std::vector<std::pair<uint64_t, std::string>> rowsOf(const std::map<std::string, uint64_t>& counts){
+        std::vector<std::pair<uint64_t, std::string>> rows;
+        for(const auto& [name, count]: counts) rows.emplace_back(count, name);
+        return rows;
+    }
+    //Hot spot table, by count and then by name
+    void writeTable(std::ostream& out, std::vector<std::pair<uint64_t, std::string>> rows, uint64_t total){
+        std::sort(rows.begin(), rows.end(), [](const auto& l, const auto& r){
+            return l.first != r.first ? l.first > r.first : l.second < r.second;
+        });
+        for(const auto& [count, name]: rows){
+            out << std::setw(14) << count << "  " << std::setw(6) << std::fixed << std::setprecision(2)
+                << share(count, total) << "%  " << name << "\n";
+        }
+    }
+}
+
+void Profiler::writeReport(std::ostream& out, const SymbolMap* symbols) const{
+    out << "Instructions retired: " << total << "\n\n";
+
+    out << "Interrupts taken:\n";
+    for(uint32_t cause = 0; cause < interrupts.size(); cause++){
+        if(const char* name = causeName(cause)) out << std::setw(14) << interrupts[cause] << "  " << name << "\n";
+    }
+
+    //Every address that retired something, in order of address
+    std::vector<std::pair<uint32_t, uint64_t>> hits;
+    std::vector<uint32_t> pageNumbers;
+    for(const auto& entry: pages) pageNumbers.push_back(entry.first);
+    std::sort(pageNumbers.begin(), pageNumbers.end());
+    for(uint32_t page: pageNumbers){
+        const Counters& counters = *pages.at(page);
+        for(uint32_t i = 0; i < counters.size(); i++){
+            if(counters[i]) hits.emplace_back(page << PagedMemory::PAGE_BITS | i << 2, counters[i]);
+        }
+    }
+
+    if(symbols){
+        std::map<std::string, uint64_t> bySection;
+        std::map<std::string, uint64_t> bySymbol;
+        for(const auto& [address, count]: hits){
+            const SymbolMap::Section* section = symbols->sectionAt(address);
+            bySection[section ? section->name : "(no section)"] += count;
+            const SymbolMap::Symbol* symbol = symbols->symbolAt(address);
+            bySymbol[symbol ? symbol->name + " (" + symbol->section + ")" : "(no symbol)"] += count;
+        }
+        out << "\nBy section:\n";
+        writeTable(out, rowsOf(bySection), total);
+        out << "\nBy symbol:\n";
+        writeTable(out, rowsOf(bySymbol), total);
+    }
+
+    out << "\nBy address:\n";
+    std::vector<std::pair<uint64_t, std::string>> rows;
+    for(const auto& [address, count]: hits){
+        std::ostringstream name;
+        name << std::hex << std::setw(8) << std::setfill('0') << address;
+        if(symbols) name << "  " << symbols->describe(address);
+        rows.emplace_back(count, name.str());
+    }
+    writeTable(out, rows, total);
+}
+std::string Profiler::frameName(uint64_t frame, const SymbolMap* symbols) const{
+    uint32_t address = static_cast<uint32_t>(frame);
+    std::string name;
+    if(symbols){
+        name = symbols->describe(address);
+    }else{
+        std::ostringstream oss;
+        oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << address;
+        name = oss.str();
+    }
+    if(const char* cause = causeName(frame >> 32)) name += std::string(" [") + cause + " interrupt]";
+    return name;
+}
+void Profiler::writeFoldedStacks(std::ostream& out, const SymbolMap* symbols) const{
+    //Stacks of every node, built from those of their parents (which always come first)
+    std::vector<std::string> stacks(nodes.size());
+    stacks[0] = "all";
+    for(uint32_t i = 1; i < nodes.size(); i++){
+        stacks[i] = stacks[nodes[i].parent] + ";" + frameName(nodes[i].frame, symbols);
+    }
+    for(uint32_t i = 0; i < nodes.size(); i++){
+        if(nodes[i].count) out << stacks[i] << " " << nodes[i].count << "\n";
+    }
+}
@@ -0,0 +1,71 @@
+#include "symbolMap.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+SymbolMap::SymbolMap(const std::string& filename){
+    parseFile(filename);
+}
+void SymbolMap::parseFile(const std::string& filename){
+    std::ifstream in(filename);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::istringstream fields(line);
+        std::string kind;
+        if (!(fields >> kind)) continue;
+        bool valid;
+        if (kind == "section") {
+            Section section;
+            valid = bool(fields >> std::hex >> section.address >> section.size >> section.name);
+            if (valid) sections.push_back(section);
+        } else if (kind == "symbol") {
+            Symbol symbol;
+            valid = bool(fields >> std::hex >> symbol.address >> symbol.section >> symbol.name);
+            if (valid) symbols.push_back(symbol);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            throw std::runtime_error("Read error: " + filename + ":" + std::to_string(lineNumber) + " is not a symbol map entry");
+        }
+    }
+    std::stable_sort(sections.begin(), sections.end(),
+        [](const Section& l, const Section& r){ return l.address < r.address; });
+    std::stable_sort(symbols.begin(), symbols.end(),
+        [](const Symbol& l, const Symbol& r){ return l.address < r.address; });
+}
+const SymbolMap::Section* SymbolMap::sectionAt(uint32_t address) const{
+    auto it = std::upper_bound(sections.begin(), sections.end(), address,
+        [](uint32_t a, const Section& s){ return a < s.address; });
+    if (it == sections.begin()) return nullptr;
+    --it;
+    return address - it->address < it->size ? &*it : nullptr;
+}
+const SymbolMap::Symbol* SymbolMap::symbolAt(uint32_t address) const{
+    const Section* section = sectionAt(address);
+    if (!section) return nullptr;
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+        [](uint32_t a, const Symbol& s){ return a < s.address; });
+    if (it == symbols.begin()) return nullptr;
+    --it;
+    //A symbol of an earlier section doesn't name the address
+    return it->address >= section->address ? &*it : nullptr;
+}
+std::string SymbolMap::describe(uint32_t address) const{
+    std::ostringstream oss;
+    const Symbol* symbol = symbolAt(address);
+    if (symbol) {
+        oss << symbol->name;
+        if (address != symbol->address) oss << "+0x" << std::hex << address - symbol->address;
+    } else {
+        oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << address;
+    }
+    return oss.str();
+}
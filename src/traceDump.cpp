@@ -0,0 +1,210 @@
+#include "traceDump.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace{
+    std::string hex32(uint32_t value){
+        std::ostringstream oss;
+        oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << value;
+        return oss.str();
+    }
+    std::string gpr(uint8_t r){
+        return "r" + std::to_string(r);
+    }
+    std::string csr(uint8_t r){
+        switch(r){
+            case 0: return "status";
+            case 1: return "handler";
+            case 2: return "cause";
+            default: return "csr" + std::to_string(r);
+        }
+    }
+    //"+D", empty for 0
+    std::string plus(int32_t disp){
+        if(disp == 0) return "";
+        return disp < 0 ? std::to_string(disp) : "+" + std::to_string(disp);
+    }
+}
+
+void TraceDump::readFile(const std::string& filename){
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || !std::equal(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC), header.magic)) {
+        throw std::runtime_error("Read error: " + filename + " is not a trace");
+    }
+    if (header.entrySize != sizeof(TraceEntry)) {
+        throw std::runtime_error("Read error: unsupported trace entry size in " + filename);
+    }
+    entries.resize(header.count);
+    in.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(TraceEntry));
+    if (!in) {
+        throw std::runtime_error("Read error: truncated trace " + filename);
+    }
+}
+void TraceDump::setSymbolMap(const std::string& mapFile){
+    symbols = std::make_unique<SymbolMap>(mapFile);
+}
+
+std::string TraceDump::disassemble(uint32_t instruction){
+    uint8_t oc = (instruction >> 4) & 0xF;
+    uint8_t mod = instruction & 0xF;
+    uint8_t a = (instruction >> 12) & 0xF;
+    uint8_t b = (instruction >> 8) & 0xF;
+    uint8_t c = (instruction >> 20) & 0xF;
+    int32_t disp = (instruction >> 8 & 0xF00) | (instruction >> 24);
+    if (disp & 0x800) disp -= 0x1000;
+
+    std::string sum = gpr(a) + "+" + gpr(b) + plus(disp);
+    static const char* const conditions[] = {"", "==", "!=", ">"};
+    static const char* const arithmetic[] = {"+", "-", "*", "/"};
+    static const char* const logic[] = {"~", "&", "|", "^"};
+    static const char* const shifts[] = {"<<", ">>"};
+    switch (oc) {
+        case 0x0:
+            return "halt";
+        case 0x1:
+            return "int";
+        case 0x2:
+            if (mod == 0) return "call " + sum;
+            if (mod == 1) return "call mem32[" + sum + "]";
+            break;
+        case 0x3: {
+            std::string target = (mod & 0x8) ? "mem32[" + gpr(a) + plus(disp) + "]" : gpr(a) + plus(disp);
+            if ((mod & 0x7) == 0) return "pc<=" + target;
+            if ((mod & 0x7) <= 3) return "if(" + gpr(b) + conditions[mod & 0x3] + gpr(c) + ") pc<=" + target;
+            break;
+        }
+        case 0x4:
+            if (mod == 0) return "xchg " + gpr(b) + ", " + gpr(c);
+            break;
+        case 0x5:
+            if (mod <= 3) return gpr(a) + "<=" + gpr(b) + arithmetic[mod] + gpr(c);
+            break;
+        case 0x6:
+            if (mod == 0) return gpr(a) + "<=~" + gpr(b);
+            if (mod <= 3) return gpr(a) + "<=" + gpr(b) + logic[mod] + gpr(c);
+            break;
+        case 0x7:
+            if (mod <= 1) return gpr(a) + "<=" + gpr(b) + shifts[mod] + gpr(c);
+            break;
+        case 0x8:
+            if (mod == 0) return "mem32[" + sum + "]<=" + gpr(c);
+            if (mod == 1) return gpr(a) + "<=" + gpr(a) + plus(disp) + "; mem32[" + gpr(a) + "]<=" + gpr(c);
+            if (mod == 2) return "mem32[mem32[" + sum + "]]<=" + gpr(c);
+            break;
+        case 0xA:
+            return "wait";
+        case 0xB:
+            if (mod == 0) return "mem8[" + gpr(a) + "..]<=mem8[" + gpr(b) + "..], " + gpr(c) + " bytes";
+            if (mod == 1) return "mem8[" + gpr(a) + "..]<=" + gpr(b) + ", " + gpr(c) + " bytes";
+            break;
+        case 0xC: {
+            static const char* const packed[] = {
+                "paddb", "psubb", "pcmpeqb", "pcmpgtb", "pminb", "pmaxb",
+                "paddh", "psubh", "pcmpeqh", "pcmpgth", "pminh", "pmaxh", "pshufb"
+            };
+            if (mod < sizeof(packed) / sizeof(packed[0])) return gpr(a) + "<=" + packed[mod] + "(" + gpr(b) + ", " + gpr(c) + ")";
+            break;
+        }
+        case 0x9:
+            switch (mod) {
+                case 0: return gpr(a) + "<=" + csr(b);
+                case 1: return gpr(a) + "<=" + gpr(b) + plus(disp);
+                case 2: return gpr(a) + "<=mem32[" + gpr(b) + "+" + gpr(c) + plus(disp) + "]";
+                case 3: return gpr(a) + "<=mem32[" + gpr(b) + "]; " + gpr(b) + "<=" + gpr(b) + plus(disp);
+                case 4: return csr(a) + "<=" + gpr(b);
+                case 5: return csr(a) + "<=" + csr(b) + "|" + std::to_string(static_cast<uint16_t>(disp));
+                case 6: return csr(a) + "<=mem32[" + gpr(b) + "+" + gpr(c) + plus(disp) + "]";
+                case 7: return csr(a) + "<=mem32[" + gpr(b) + "]; " + gpr(b) + "<=" + gpr(b) + plus(disp);
+            }
+            break;
+    }
+    return "illegal";
+}
+
+void TraceDump::print(std::ostream& out, size_t last) const{
+    size_t first = last != 0 && last < entries.size() ? entries.size() - last : 0;
+    //Number of the first entry held among all instructions traced
+    uint64_t base = header.recorded - entries.size();
+    for (size_t i = first; i < entries.size(); ++i) {
+        const TraceEntry& entry = entries[i];
+        std::ostringstream line;
+        line << std::setw(12) << base + i << "  " << hex32(entry.pc);
+        if (symbols) {
+            std::string name = symbols->symbolAt(entry.pc) ? symbols->describe(entry.pc) : "";
+            line << " " << std::left << std::setw(20) << name << std::right;
+        }
+        line << "  " << std::hex << std::setfill('0');
+        for (int byte = 0; byte < 4; ++byte) {
+            line << std::setw(2) << ((entry.instruction >> (8 * byte)) & 0xFF) << " ";
+        }
+        line << std::setfill(' ') << " " << std::left << std::setw(36) << disassemble(entry.instruction) << std::right;
+        line << " value=" << hex32(entry.value);
+        if (entry.address != 0) line << " address=" << hex32(entry.address);
+        out << line.str() << "\n";
+    }
+}
+
+void printUsage(const char* progName) {
+    std::cout << "Usage: " << progName << " [options] <trace>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h           Show this help message and exit\n";
+    std::cout << "  -last=N      Print only the last N instructions\n";
+    std::cout << "  -map=FILE    Symbol map written by the linker (-map), to name code addresses\n\n";
+    std::cout << "Example:\n";
+    std::cout << "  " << progName << " program.trace -last=100 -map=program.map\n\n";
+}
+int main(int argc, char** argv){
+    TraceDump dump;
+    std::string inputFile;
+    std::string mapFile;
+    size_t last = 0;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg.rfind("-last=", 0) == 0) {
+                //std::stoull would wrap a negative count around
+                if (arg.size() > 6 && arg[6] == '-') throw std::invalid_argument(arg);
+                last = std::stoull(arg.substr(6), nullptr, 0);
+            } else if (arg.rfind("-map=", 0) == 0) {
+                mapFile = arg.substr(5);
+            } else if (inputFile.empty()) {
+                inputFile = arg;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {
+        std::cerr << "Invalid option value\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (inputFile.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        dump.readFile(inputFile);
+        if (!mapFile.empty()) dump.setSymbolMap(mapFile);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    dump.print(std::cout, last);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include "traceRing.hpp"
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+TraceRing::TraceRing(size_t capacity){
+    size_t size = 1;
+    //Stops at the largest power of two a size_t holds instead of overflowing to 0
+    while (size < capacity && size <= SIZE_MAX / 2) size <<= 1;
+    entries.resize(size);
+    mask = size - 1;
+}
+void TraceRing::write(const std::string& filename) const{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    TraceHeader header;
+    std::copy(std::begin(TRACE_MAGIC), std::end(TRACE_MAGIC), header.magic);
+    header.recorded = recorded;
+    header.count = std::min<uint64_t>(recorded, entries.size());
+    header.entrySize = sizeof(TraceEntry);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    //Once the ring wrapped around, the oldest entry is the next one to be overwritten
+    size_t first = recorded > entries.size() ? recorded & mask : 0;
+    size_t tail = std::min<size_t>(header.count, entries.size() - first);
+    out.write(reinterpret_cast<const char*>(entries.data() + first), tail * sizeof(TraceEntry));
+    out.write(reinterpret_cast<const char*>(entries.data()), (header.count - tail) * sizeof(TraceEntry));
+    if (!out) {
+        throw std::runtime_error("Write error: " + filename);
+    }
+}
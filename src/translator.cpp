@@ -0,0 +1,522 @@
+#include "translator.hpp"
+#include "pagedMemory.hpp"
+#include "packedLanes.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace{
+    std::string hex32(uint32_t value){
+        std::ostringstream oss;
+        oss << "0x" << std::hex << std::setw(8) << std::setfill('0') << value << "u";
+        return oss.str();
+    }
+    std::string blockName(uint32_t address){
+        std::ostringstream oss;
+        oss << "block_" << std::hex << std::setw(8) << std::setfill('0') << address;
+        return oss.str();
+    }
+    //Register as read by an instruction
+    std::string reg(uint8_t r){
+        return "r[" + std::to_string(r) + "]";
+    }
+    //" + D" with the displacement in two's complement, so that the arithmetic stays unsigned
+    std::string plus(int32_t disp){
+        if(disp == 0) return "";
+        if(disp < 0) return " - " + std::to_string(-disp) + "u";
+        return " + " + std::to_string(disp) + "u";
+    }
+}
+
+void Translator::readFile(const std::string& filename){
+    image = std::make_unique<ImageReader>(filename);
+    segments = image->getSegments();
+}
+void Translator::addEntryPoint(uint32_t address){
+    entryPoints.insert(address);
+}
+
+bool Translator::isLoaded(uint32_t address) const{
+    //Last segment starting at or before the address
+    auto it = std::upper_bound(segments.begin(), segments.end(), address,
+        [](uint32_t a, const ImageReader::Segment& s){ return a < s.address; });
+    if(it == segments.begin()) return false;
+    --it;
+    return address - it->address + 4 <= it->size && address <= 0xFFFFFFFCu;
+}
+uint32_t Translator::readWord(uint32_t address) const{
+    auto it = std::upper_bound(segments.begin(), segments.end(), address,
+        [](uint32_t a, const ImageReader::Segment& s){ return a < s.address; });
+    --it;
+    const uint8_t* p = it->bytes + (address - it->address);
+    return static_cast<uint32_t>(p[0])
+        | (static_cast<uint32_t>(p[1]) << 8)
+        | (static_cast<uint32_t>(p[2]) << 16)
+        | (static_cast<uint32_t>(p[3]) << 24);
+}
+bool Translator::knownLiteral(const Instruction& in, uint32_t literalAddress, uint32_t& value) const{
+    uint32_t page = in.address & ~PagedMemory::PAGE_MASK;
+    if((literalAddress & ~PagedMemory::PAGE_MASK) != page) return false;
+    if((literalAddress & PagedMemory::PAGE_MASK) > PagedMemory::PAGE_SIZE - 4) return false;
+    if(!isLoaded(literalAddress)) return false;
+    value = readWord(literalAddress);
+    return true;
+}
+
+Translator::Instruction Translator::decode(uint32_t address, uint32_t word){
+    Instruction in;
+    in.address = address;
+    in.word = word;
+    //byte0: oc | mod
+    in.oc = (word >> 4) & 0x0F;
+    in.mod = word & 0x0F;
+    //byte1: a | b
+    in.a = (word >> 12) & 0x0F;
+    in.b = (word >> 8) & 0x0F;
+    //byte2: c | disp11..8, byte3: disp7..0
+    in.c = (word >> 20) & 0x0F;
+    int32_t disp = (((word >> 16) & 0x0F) << 8) | ((word >> 24) & 0xFF);
+    if (disp & 0x800) disp -= 0x1000; //extend sign if disp was negative
+    in.disp = disp;
+    return in;
+}
+bool Translator::hasIllegalFields(const Instruction& in){
+    switch(in.oc){
+        case 0x0: //Halt
+        case 0x1: //Software interrupt
+        case 0xA: //Wait
+            return in.mod != 0 || in.a != 0 || in.b != 0 || in.c != 0 || in.disp != 0;
+        case 0x2: //Call
+            return in.c != 0;
+        case 0x4: //Xchg
+            return in.mod != 0 || in.a != 0 || in.disp != 0;
+        case 0x5: //Arithmetic
+        case 0x6: //Logic
+        case 0x7: //Shift
+        case 0xB: //Block copy and fill
+        case 0xC: //Packed arithmetic
+            return in.disp != 0;
+        default:
+            return false;
+    }
+}
+
+void Translator::discoverBlocks(){
+    std::vector<uint32_t> worklist(entryPoints.begin(), entryPoints.end());
+    worklist.push_back(START_ADDRESS);
+    while(!worklist.empty()){
+        uint32_t start = worklist.back();
+        worklist.pop_back();
+        if((start & 0x3) != 0 || start >= MMIO_START || !isLoaded(start)) continue;
+        if(blocks.count(start)) continue;
+        formBlock(start, blocks[start], worklist);
+    }
+}
+void Translator::formBlock(uint32_t start, Block& block, std::vector<uint32_t>& successors) const{
+    uint32_t page = start & ~PagedMemory::PAGE_MASK;
+    uint32_t address = start;
+    while(true){
+        Instruction in = decode(address, readWord(address));
+        block.instructions.push_back(in);
+
+        uint32_t nextAddress;
+        if(!continuesBlock(in, nextAddress, successors)) break;
+        //Blocks stay within one page, don't run backwards and don't leave the image
+        if((nextAddress & ~PagedMemory::PAGE_MASK) != page || nextAddress <= address
+            || (nextAddress & 0x3) != 0 || !isLoaded(nextAddress)){
+            successors.push_back(nextAddress);
+            break;
+        }
+        address = nextAddress;
+    }
+}
+bool Translator::continuesBlock(const Instruction& in, uint32_t& nextAddress, std::vector<uint32_t>& successors) const{
+    uint32_t next = in.address + 4;
+    uint32_t value;
+    nextAddress = next;
+    if(hasIllegalFields(in)){
+        //The interrupt handler may return right after the instruction
+        successors.push_back(next);
+        return false;
+    }
+    switch(in.oc){
+        case 0x0: //Halt
+            return false;
+        case 0x1: //Software interrupt
+        case 0xA: //Wait
+            successors.push_back(next);
+            return false;
+        case 0x2: //Call
+            successors.push_back(next);
+            if(in.a == PC && in.b == 0){
+                if(in.mod == 0) successors.push_back(next + in.disp);
+                if(in.mod == 1 && knownLiteral(in, next + in.disp, value)) successors.push_back(value);
+            }
+            return false;
+        case 0x3: //Jump
+            if(in.mod != 0 && in.mod != 8) successors.push_back(next);
+            if(in.a == PC){
+                if(in.mod <= 3) successors.push_back(next + in.disp);
+                if(in.mod >= 8 && in.mod <= 11 && knownLiteral(in, next + in.disp, value)) successors.push_back(value);
+            }
+            return false;
+        case 0x4: //Xchg
+            return in.b != PC && in.c != PC;
+        case 0x5: //Arithmetic
+            //Division by zero raises an interrupt the handler may return from
+            if(in.mod == 3) successors.push_back(next);
+            return in.mod <= 3 && in.a != PC;
+        case 0x6: //Logic
+            return in.mod <= 3 && in.a != PC;
+        case 0x7: //Shift
+            return in.mod <= 1 && in.a != PC;
+        case 0x8: //Store
+            return in.mod <= 2 && !(in.mod == 1 && in.a == PC);
+        case 0x9: //Load
+            if(in.mod > 7 || (in.mod <= 3 && in.a == PC)) return false;
+            if((in.mod == 3 || in.mod == 7) && in.b == PC){
+                //gpr[B]<=gpr[B]+D moves PC by a known amount (skips over an inline literal)
+                nextAddress = next + in.disp;
+                //A loaded address (ld $handler, %r1 and the like) may well be code
+                if(in.mod == 3 && knownLiteral(in, next, value)) successors.push_back(value);
+            }
+            return true;
+        case 0xB: //Block copy and fill
+            return in.mod <= 1;
+        case 0xC: //Packed arithmetic
+            return in.mod < PackedLanes::OPERATIONS && in.a != PC;
+        default:
+            //Illegal opcodes
+            successors.push_back(next);
+            return false;
+    }
+}
+
+bool Translator::emitInstruction(std::ostream& out, const Instruction& in, size_t retired) const{
+    //Register as written by the instruction
+    auto dst = [](uint8_t r){ return reg(r == 0 ? SINK : r); };
+    //Return to the emulator, counting the instructions executed so far
+    const std::string ret = "    rt.retire(" + std::to_string(retired) + ");\n    return;\n";
+    //Return to the emulator if the write stopped the block
+    const std::string checkExit = "    if(rt.exit()){ rt.retire(" + std::to_string(retired) + "); return; }\n";
+    //Return to the emulator after the instruction if it may change PC or raised an interrupt
+    auto endsUnless = [&out, &ret](bool ends){
+        if(ends) out << ret;
+        return !ends;
+    };
+    uint32_t next = in.address + 4;
+    uint32_t value;
+
+    out << "    //" << std::hex << std::setw(8) << std::setfill('0') << in.address << ":";
+    for(int i = 0; i < 4; i++){
+        out << " " << std::setw(2) << ((in.word >> (8 * i)) & 0xFF);
+    }
+    out << std::dec << std::setfill(' ') << "\n";
+    out << "    r[15] = " << hex32(next) << ";\n";
+
+    bool illegalFields = hasIllegalFields(in);
+    if(illegalFields){
+        //The instruction is still executed, as if the fields were allowed
+        out << "    rt.illegalInstruction();\n";
+    }
+    std::string a = reg(in.a), b = reg(in.b), c = reg(in.c);
+    switch(in.oc){
+        case 0x0: //Halt
+            out << "    rt.halt();\n" << ret;
+            return false;
+        case 0x1: //Software interrupt
+            out << "    rt.softwareInterrupt();\n" << ret;
+            return false;
+        case 0xA: //Wait
+            out << "    rt.idle();\n" << ret;
+            return false;
+        case 0x2: //Call
+            if(in.mod > 1) break;
+            out << "    r[14] -= 4;\n    rt.write(r[14], r[15]);\n";
+            if(in.mod == 0){
+                if(in.a == PC && in.b == 0) out << "    r[15] = " << hex32(next + in.disp) << ";\n";
+                else out << "    r[15] = " << a << " + " << b << plus(in.disp) << ";\n";
+            }else{
+                if(in.a == PC && in.b == 0 && knownLiteral(in, next + in.disp, value))
+                    out << "    r[15] = " << hex32(value) << ";\n";
+                else out << "    r[15] = rt.read(" << a << " + " << b << plus(in.disp) << ");\n";
+            }
+            out << ret;
+            return false;
+        case 0x3:{ //Jump
+            //Bit 3 of the modifier selects a target read from memory, the rest the condition
+            uint8_t kind = in.mod & 0x7;
+            bool indirect = (in.mod & 0x8) != 0;
+            if(kind > 3) break;
+            std::string target;
+            //Target known while translating
+            bool known = false;
+            if(!indirect){
+                target = in.a == PC ? hex32(next + in.disp) : a + plus(in.disp);
+                known = in.a == PC;
+                value = next + in.disp;
+            }else{
+                known = in.a == PC && knownLiteral(in, next + in.disp, value);
+                target = known ? hex32(value) : "rt.read(" + a + plus(in.disp) + ")";
+            }
+            //Comparing a register with itself decides the branch while translating
+            if(kind != 0 && in.b == in.c) kind = kind == 1 ? 0 : 4;
+            //A jump to itself idles until an interrupt comes
+            if(kind == 0 && known && value == in.address) out << "    rt.idle();\n";
+            if(kind == 0) out << "    r[15] = " << target << ";\n";
+            else if(kind == 1) out << "    if(" << b << " == " << c << ") r[15] = " << target << ";\n";
+            else if(kind == 2) out << "    if(" << b << " != " << c << ") r[15] = " << target << ";\n";
+            else if(kind == 3) out << "    if(static_cast<int32_t>(" << b << ") > static_cast<int32_t>(" << c << ")) r[15] = " << target << ";\n";
+            out << ret;
+            return false;
+        }
+        case 0x4: //Xchg
+            out << "    { uint32_t temp = " << b << "; " << dst(in.b) << " = " << c << "; " << dst(in.c) << " = temp; }\n";
+            return endsUnless(illegalFields || in.b == PC || in.c == PC);
+        case 0x5: //Arithmetic
+            if(in.mod == 0) out << "    " << dst(in.a) << " = " << b << " + " << c << ";\n";
+            else if(in.mod == 1) out << "    " << dst(in.a) << " = " << b << " - " << c << ";\n";
+            else if(in.mod == 2) out << "    " << dst(in.a) << " = " << b << " * " << c << ";\n";
+            else if(in.mod == 3){
+                out << "    if(" << c << " != 0) " << dst(in.a) << " = static_cast<uint32_t>(static_cast<int32_t>("
+                    << b << ") / static_cast<int32_t>(" << c << "));\n";
+                out << "    else rt.illegalInstruction();\n" << checkExit;
+            }
+            else break;
+            return endsUnless(illegalFields || in.a == PC);
+        case 0x6: //Logic
+            if(in.mod == 0) out << "    " << dst(in.a) << " = ~" << b << ";\n";
+            else if(in.mod == 1) out << "    " << dst(in.a) << " = " << b << " & " << c << ";\n";
+            else if(in.mod == 2) out << "    " << dst(in.a) << " = " << b << " | " << c << ";\n";
+            else if(in.mod == 3) out << "    " << dst(in.a) << " = " << b << " ^ " << c << ";\n";
+            else break;
+            return endsUnless(illegalFields || in.a == PC);
+        case 0x7: //Shift
+            if(in.mod == 0) out << "    " << dst(in.a) << " = " << b << " << (" << c << " & 31);\n";
+            else if(in.mod == 1) out << "    " << dst(in.a) << " = static_cast<uint32_t>(static_cast<int32_t>("
+                << b << ") >> (" << c << " & 31));\n";
+            else break;
+            return endsUnless(illegalFields || in.a == PC);
+        case 0x8: //Store
+            if(in.mod == 0){
+                out << "    rt.write(" << a << " + " << b << plus(in.disp) << ", " << c << ");\n";
+            }else if(in.mod == 1){
+                out << "    " << dst(in.a) << " = " << a << plus(in.disp) << ";\n";
+                out << "    rt.write(" << a << ", " << c << ");\n";
+                if(in.a == PC){
+                    out << ret;
+                    return false;
+                }
+            }else if(in.mod == 2){
+                if(in.a == PC && in.b == 0 && knownLiteral(in, next + in.disp, value))
+                    out << "    rt.write(" << hex32(value) << ", " << c << ");\n";
+                else out << "    rt.write(rt.read(" << a << " + " << b << plus(in.disp) << "), " << c << ");\n";
+            }else{
+                break;
+            }
+            out << checkExit;
+            return true;
+        case 0x9: //Load
+            switch(in.mod){
+                case 0: out << "    " << dst(in.a) << " = csr[" << int(in.b) << "];\n"; break;
+                case 1: out << "    " << dst(in.a) << " = " << b << plus(in.disp) << ";\n"; break;
+                case 2: out << "    " << dst(in.a) << " = rt.read(" << b << " + " << c << plus(in.disp) << ");\n"; break;
+                case 3:
+                    if(in.b == PC && knownLiteral(in, next, value)) out << "    " << dst(in.a) << " = " << hex32(value) << ";\n";
+                    else out << "    " << dst(in.a) << " = rt.read(" << b << ");\n";
+                    out << "    " << dst(in.b) << " = " << b << plus(in.disp) << ";\n";
+                    break;
+                case 4: out << "    csr[" << int(in.a) << "] = " << b << ";\n"; break;
+                case 5: out << "    csr[" << int(in.a) << "] = csr[" << int(in.b) << "] | "
+                    << static_cast<uint16_t>(in.disp) << ";\n"; break;
+                case 6: out << "    csr[" << int(in.a) << "] = rt.read(" << b << " + " << c << plus(in.disp) << ");\n"; break;
+                case 7:
+                    out << "    csr[" << int(in.a) << "] = rt.read(" << b << ");\n";
+                    out << "    " << dst(in.b) << " = " << b << plus(in.disp) << ";\n";
+                    break;
+                default:
+                    out << "    rt.illegalInstruction();\n" << ret;
+                    return false;
+            }
+            //The emulator keeps headless input back until the handler is installed
+            if(in.mod >= 4 && in.a == 1) out << "    rt.handlerInstalled();\n";
+            if(in.mod <= 3 && in.a == PC){
+                out << ret;
+                return false;
+            }
+            return true;
+        case 0xB: //Block copy and fill
+            if(in.mod == 0) out << "    rt.copy(" << a << ", " << b << ", " << c << ");\n";
+            else if(in.mod == 1) out << "    rt.fill(" << a << ", " << b << ", " << c << ");\n";
+            else break;
+            //The block may have overwritten code
+            out << checkExit;
+            return true;
+        case 0xC: //Packed arithmetic
+            if(in.mod >= PackedLanes::OPERATIONS) break;
+            out << "    " << dst(in.a) << " = PackedLanes::apply<" << int(in.mod) << ">(" << b << ", " << c << ");\n";
+            return endsUnless(illegalFields || in.a == PC);
+        default:
+            break;
+    }
+    //Opcodes and modifiers that don't exist
+    out << "    rt.illegalInstruction();\n" << ret;
+    return false;
+}
+void Translator::emitBlock(std::ostream& out, uint32_t start, const Block& block) const{
+    out << "static void " << blockName(start) << "(AotRuntime& rt){\n";
+    out << "    uint32_t* r = rt.gpr;\n";
+    out << "    int* csr = rt.csr;\n";
+    out << "    (void)csr;\n";
+    size_t retired = 0;
+    bool fallsThrough = true;
+    for(const auto& in: block.instructions){
+        fallsThrough = emitInstruction(out, in, ++retired);
+        if(!fallsThrough) break;
+    }
+    if(fallsThrough) out << "    rt.retire(" << retired << ");\n";
+    out << "}\n";
+}
+void Translator::emitImage(std::ostream& out) const{
+    for(size_t i = 0; i < segments.size(); i++){
+        out << "static const uint8_t segment" << i << "[] = {";
+        const uint8_t* bytes = segments[i].bytes;
+        for(size_t j = 0; j < segments[i].size; j++){
+            if(j % 16 == 0) out << "\n    ";
+            out << "0x" << std::hex << std::setw(2) << std::setfill('0') << int(bytes[j]) << std::dec << ",";
+        }
+        out << "\n};\n";
+    }
+    out << "static const AotRuntime::Segment segments[] = {\n";
+    for(size_t i = 0; i < segments.size(); i++){
+        out << "    {" << hex32(segments[i].address) << ", segment" << i << ", sizeof(segment" << i << ")},\n";
+    }
+    out << "};\n\n";
+
+    std::set<uint32_t> pages;
+    for(const auto& block: blocks){
+        pages.insert(block.first >> PagedMemory::PAGE_BITS);
+    }
+    out << "static const uint32_t codePages[] = {\n";
+    for(uint32_t page: pages){
+        out << "    " << hex32(page) << ",\n";
+    }
+    out << "};\n\n";
+
+    out << "static AotRuntime::Block dispatch(uint32_t pc){\n";
+    out << "    switch(pc){\n";
+    for(const auto& block: blocks){
+        out << "        case " << hex32(block.first) << ": return &" << blockName(block.first) << ";\n";
+    }
+    out << "        default: return nullptr;\n";
+    out << "    }\n";
+    out << "}\n\n";
+
+    out << "int main(int argc, char** argv){\n";
+    out << "    static const AotRuntime::Image image = {\n";
+    out << "        segments, sizeof(segments) / sizeof(segments[0]),\n";
+    out << "        codePages, sizeof(codePages) / sizeof(codePages[0]),\n";
+    out << "        &dispatch\n";
+    out << "    };\n";
+    out << "    return AotRuntime::run(argc, argv, image);\n";
+    out << "}\n";
+}
+
+void Translator::translate(const std::string& outputFilename){
+    if(segments.empty()){
+        throw std::runtime_error("Input error: the executable is empty");
+    }
+    blocks.clear();
+    discoverBlocks();
+
+    std::ofstream out(outputFilename);
+    if(!out){
+        throw std::runtime_error("Cannot open file: " + outputFilename);
+    }
+    out << "//Generated by the translator, do not edit\n";
+    out << "#include \"aotRuntime.hpp\"\n\n";
+    for(const auto& block: blocks){
+        emitBlock(out, block.first, block.second);
+        out << "\n";
+    }
+    emitImage(out);
+    if(!out){
+        throw std::runtime_error("Write error: " + outputFilename);
+    }
+}
+
+void printUsage(const char* progName) {
+    std::cout << "\nUsage: " << progName << " [options] <file>\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -h                   Show this help message and exit.\n";
+    std::cout << "  -o <file>            Specify output file (C++ source).\n";
+    std::cout << "  -entry=ADDR          Translate code starting at the address as well (can be repeated).\n\n";
+    std::cout << "Examples:\n";
+    std::cout << "  " << progName << " program.hex -o program.cpp\n";
+    std::cout << "  g++ -O2 -Iinc program.cpp out/libemulator.a -lpthread -o program\n";
+    std::cout << "\n";
+    std::cout << "Notes:\n";
+    std::cout << "  " << "-Code is found by following control flow from 0x40000000, from -entry addresses and from addresses loaded as literals.\n";
+    std::cout << "  " << "-Code that isn't found (or is overwritten at run time) is still executed by the emulator.\n";
+    std::cout << "\n";
+}
+int main(int argc, char** argv){
+    Translator translator;
+    std::string inputFile;
+    std::string outputFile;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg == "-o") {
+                if (i + 1 >= argc) {
+                    std::cerr << "-o requires an argument\n";
+                    return 1;
+                }
+                outputFile = argv[++i];
+            } else if (arg.rfind("-entry=", 0) == 0) {
+                unsigned long entry = std::stoul(arg.substr(7), nullptr, 0);
+                if (entry > 0xFFFFFFFFUL) throw std::out_of_range("entry address");
+                translator.addEntryPoint(static_cast<uint32_t>(entry));
+            } else if (inputFile.empty()) {
+                inputFile = arg;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::logic_error&) {
+        //A number that std::stoul couldn't parse, or that doesn't fit
+        std::cerr << "Invalid option value\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (inputFile.empty() || outputFile.empty()) {
+        std::cerr << "Input and output files must be specified\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        translator.readFile(inputFile);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error reading file " << inputFile << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    try {
+        translator.translate(outputFile);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}